@@ -0,0 +1,91 @@
+#include "osal/clock.h"
+#include "osal/os.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+namespace {
+
+void monotonic_ns(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(os::clock::monotonic_ns());
+}
+
+void monotonic_coarse_ns(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(os::clock::monotonic_coarse_ns());
+}
+
+void realtime_ns(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(os::clock::realtime_ns());
+}
+
+void cycles(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(os::clock::cycles());
+}
+
+void cycles_to_ns(benchmark::State& state)
+{
+    os::clock::calibrate();
+    uint64_t c = os::clock::cycles();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(os::clock::cycles_to_ns(c++));
+}
+
+void time_since_epoch(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(os::time_since_epoch());
+}
+
+void steady_clock(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(std::chrono::steady_clock::now());
+}
+
+/// 1 kHz loop, reports how late each wake-up is relative to its deadline
+template <void (*Sleep)(uint64_t)>
+void periodic_1khz(benchmark::State& state)
+{
+    std::vector<double> late;
+    auto next = os::clock::monotonic_ns();
+    for (auto _ : state)
+    {
+        next += os::clock::ms_to_ns(1);
+        Sleep(next);
+        late.push_back(static_cast<double>(os::clock::monotonic_ns() - next));
+    }
+    std::sort(late.begin(), late.end());
+    state.counters["late_p50_ns"] = late[late.size() / 2];
+    state.counters["late_p99_ns"] = late[late.size() * 99 / 100];
+}
+
+void relative_sleep(uint64_t deadline_ns)
+{
+    auto now = os::clock::monotonic_ns();
+    if (now < deadline_ns)
+        os::sleep_for_ns(deadline_ns - now);
+}
+void deadline_sleep(uint64_t deadline_ns) { os::sleep_until(deadline_ns); }
+void precise_sleep(uint64_t deadline_ns) { os::precise_sleep_until(deadline_ns); }
+
+} // namespace
+
+BENCHMARK(monotonic_ns);
+BENCHMARK(monotonic_coarse_ns);
+BENCHMARK(realtime_ns);
+BENCHMARK(cycles);
+BENCHMARK(cycles_to_ns);
+BENCHMARK(time_since_epoch);
+BENCHMARK(steady_clock);
+BENCHMARK_TEMPLATE(periodic_1khz, relative_sleep)->Iterations(2000);
+BENCHMARK_TEMPLATE(periodic_1khz, deadline_sleep)->Iterations(2000);
+BENCHMARK_TEMPLATE(periodic_1khz, precise_sleep)->Iterations(2000);
@@ -0,0 +1,428 @@
+#include "osal/copy_tree.h"
+#include "osal/disk_usage.h"
+#include "osal/glob.h"
+#include "osal/os.h"
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <cstring>
+#include <regex>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Scratch directories and sweep limits come from the environment:
+//   OSAL_BENCH_TMPFS_DIR         memory backed directory (default /dev/shm)
+//   OSAL_BENCH_DISK_DIR          disk backed directory (default /var/tmp)
+//   OSAL_BENCH_MAX_FILE_SIZE     largest file in bytes (default 1 GiB)
+//   OSAL_BENCH_MAX_DIR_ENTRIES   largest directory (default 1000000)
+//
+// Files read back are usually in the page cache, so read and copy_file measure the cached path
+// unless caches are dropped between runs.
+
+namespace {
+
+enum backing { tmpfs, disk };
+
+const char* backing_name(int64_t b) { return b == tmpfs ? "tmpfs" : "disk"; }
+
+std::string env_or(const char* name, const char* fallback)
+{
+    auto v = std::getenv(name);
+    return v && *v ? v : fallback;
+}
+
+int64_t env_or(const char* name, int64_t fallback)
+{
+    auto v = std::getenv(name);
+    return v && *v ? std::strtoll(v, nullptr, 0) : fallback;
+}
+
+std::string scratch_root(int64_t b)
+{
+    auto base = b == tmpfs ? env_or("OSAL_BENCH_TMPFS_DIR", "/dev/shm") : env_or("OSAL_BENCH_DISK_DIR", "/var/tmp");
+    return os::file::join(base, "osal_bench_file");
+}
+
+/// Read and write family syscalls made by this process so far, from /proc/self/io (0 elsewhere)
+uint64_t io_syscalls()
+{
+#ifdef __linux__
+    char buf[512];
+    auto fd = ::open("/proc/self/io", O_RDONLY);
+    if (fd < 0)
+        return 0;
+    auto n = ::read(fd, buf, sizeof(buf) - 1);
+    ::close(fd);
+    if (n <= 0)
+        return 0;
+    buf[n] = '\0';
+
+    uint64_t total = 0;
+    for (auto key : {"syscr: ", "syscw: "})
+    {
+        if (auto p = std::strstr(buf, key))
+            total += std::strtoull(p + std::strlen(key), nullptr, 10);
+    }
+    return total;
+#else
+    return 0;
+#endif
+}
+
+/// Adds a per-iteration "io_syscalls" counter covering the calls between start() and stop()
+///
+/// Only read and write family calls are counted (syscr + syscw), open, stat and getdents are not.
+class syscall_counter {
+public:
+    syscall_counter()
+    {
+        // Reading /proc/self/io is itself a read, measure what a back to back pair costs
+        auto a     = io_syscalls();
+        m_overhead = io_syscalls() - a;
+    }
+
+    void start() { m_start = io_syscalls(); }
+    void stop()
+    {
+        auto used = io_syscalls() - m_start;
+        m_total += used > m_overhead ? used - m_overhead : 0;
+    }
+
+    void report(benchmark::State& state) const
+    {
+        state.counters["io_syscalls"] = benchmark::Counter(static_cast<double>(m_total), benchmark::Counter::kAvgIterations);
+    }
+
+private:
+    uint64_t m_overhead{0};
+    uint64_t m_start{0};
+    uint64_t m_total{0};
+};
+
+/// Creates an empty scratch directory and removes it with everything in it
+class scratch_dir {
+public:
+    explicit scratch_dir(int64_t b)
+        : m_path(scratch_root(b))
+    {
+        os::file::delete_dir(m_path);
+        m_ok = os::file::create_dir(m_path);
+    }
+    scratch_dir(const scratch_dir& other) = delete;
+    scratch_dir& operator=(const scratch_dir& other) = delete;
+    ~scratch_dir() { os::file::delete_dir(m_path); }
+
+    explicit operator bool() const { return m_ok; }
+    std::string join(const std::string& name) const { return os::file::join(m_path, name); }
+
+    bool populate(const std::string& dir, int64_t entries) const
+    {
+        auto path = join(dir);
+        if (!os::file::create_dir(path))
+            return false;
+        for (int64_t i = 0; i < entries; i++)
+        {
+            if (!os::file::touch(os::file::join(path, std::to_string(i)).c_str()))
+                return false;
+        }
+        return true;
+    }
+
+private:
+    std::string m_path;
+    bool m_ok;
+};
+
+void file_sizes(benchmark::internal::Benchmark* b)
+{
+    auto max = env_or("OSAL_BENCH_MAX_FILE_SIZE", int64_t(1) << 30);
+    for (int64_t backing : {tmpfs, disk})
+    {
+        for (int64_t size = 1 << 10; size <= max; size *= 32)
+            b->Args({size, backing});
+    }
+    b->ArgNames({"bytes", "backing"})->UseRealTime();
+}
+
+void dir_sizes(benchmark::internal::Benchmark* b)
+{
+    auto max = env_or("OSAL_BENCH_MAX_DIR_ENTRIES", int64_t(1000000));
+    for (int64_t backing : {tmpfs, disk})
+    {
+        for (int64_t entries = 10; entries <= max; entries *= 10)
+            b->Args({entries, backing});
+    }
+    b->ArgNames({"entries", "backing"})->UseRealTime();
+}
+
+void dump(benchmark::State& state)
+{
+    scratch_dir dir(state.range(1));
+    std::string data(static_cast<std::size_t>(state.range(0)), 'x');
+    auto path = dir.join("dump");
+    if (!dir)
+        return state.SkipWithError("cannot create scratch directory");
+
+    syscall_counter sys;
+    for (auto _ : state)
+    {
+        sys.start();
+        auto n = os::file::dump(path, data);
+        sys.stop();
+        if (n != data.size())
+            return state.SkipWithError("short write");
+    }
+    sys.report(state);
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    state.SetLabel(backing_name(state.range(1)));
+}
+
+void read(benchmark::State& state)
+{
+    scratch_dir dir(state.range(1));
+    auto path = dir.join("read");
+    {
+        std::string data(static_cast<std::size_t>(state.range(0)), 'x');
+        if (!dir || os::file::dump(path, data) != data.size())
+            return state.SkipWithError("cannot create input file");
+    }
+
+    syscall_counter sys;
+    for (auto _ : state)
+    {
+        sys.start();
+        auto r = os::file::read(path);
+        sys.stop();
+        benchmark::DoNotOptimize(r.data.get());
+    }
+    sys.report(state);
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    state.SetLabel(backing_name(state.range(1)));
+}
+
+void copy_file(benchmark::State& state)
+{
+    scratch_dir dir(state.range(1));
+    auto src = dir.join("src");
+    auto dst = dir.join("dst");
+    {
+        std::string data(static_cast<std::size_t>(state.range(0)), 'x');
+        if (!dir || os::file::dump(src, data) != data.size())
+            return state.SkipWithError("cannot create input file");
+    }
+
+    syscall_counter sys;
+    for (auto _ : state)
+    {
+        sys.start();
+        os::file::copy_file(src, dst);
+        sys.stop();
+    }
+    sys.report(state);
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    state.SetLabel(backing_name(state.range(1)));
+}
+
+void list_dir(benchmark::State& state)
+{
+    scratch_dir dir(state.range(1));
+    if (!dir || !dir.populate("list", state.range(0)))
+        return state.SkipWithError("cannot create directory entries");
+    auto path = dir.join("list");
+
+    syscall_counter sys;
+    for (auto _ : state)
+    {
+        sys.start();
+        auto l = os::file::list_dir(path);
+        sys.stop();
+        benchmark::DoNotOptimize(l.size());
+    }
+    sys.report(state);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetLabel(backing_name(state.range(1)));
+}
+
+void list_dir_arena(benchmark::State& state)
+{
+    scratch_dir dir(state.range(1));
+    if (!dir || !dir.populate("list", state.range(0)))
+        return state.SkipWithError("cannot create directory entries");
+    auto path = dir.join("list");
+
+    auto& a = os::arena::local();
+    for (auto _ : state)
+    {
+        auto l = os::file::list_dir(path.c_str(), a);
+        benchmark::DoNotOptimize(l.size());
+        a.reset();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetLabel(backing_name(state.range(1)));
+}
+
+void disk_usage(benchmark::State& state)
+{
+    scratch_dir dir(state.range(1));
+    if (!dir || !dir.populate("usage", state.range(0)))
+        return state.SkipWithError("cannot create directory entries");
+    auto path = dir.join("usage");
+
+    for (auto _ : state)
+    {
+        auto report = os::file::disk_usage(path);
+        benchmark::DoNotOptimize(report.total.files);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetLabel(backing_name(state.range(1)));
+}
+
+void copy_tree(benchmark::State& state)
+{
+    scratch_dir dir(state.range(1));
+    if (!dir || !dir.populate("tree", state.range(0)))
+        return state.SkipWithError("cannot create directory entries");
+    auto src = dir.join("tree");
+    auto dst = dir.join("copy");
+
+    for (auto _ : state)
+    {
+        auto report = os::file::copy_tree(src, dst);
+        benchmark::DoNotOptimize(report.files);
+        state.PauseTiming();
+        os::file::delete_dir(dst);
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetLabel(backing_name(state.range(1)));
+}
+
+void delete_dir(benchmark::State& state)
+{
+    scratch_dir dir(state.range(1));
+    if (!dir)
+        return state.SkipWithError("cannot create scratch directory");
+    auto path = dir.join("delete");
+
+    syscall_counter sys;
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        if (!dir.populate("delete", state.range(0)))
+            return state.SkipWithError("cannot create directory entries");
+        state.ResumeTiming();
+
+        sys.start();
+        os::file::delete_dir(path);
+        sys.stop();
+    }
+    sys.report(state);
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetLabel(backing_name(state.range(1)));
+}
+
+void size(benchmark::State& state)
+{
+    scratch_dir dir(state.range(0));
+    auto path = dir.join("size");
+    if (!dir || os::file::dump(path, "x", 1) != 1)
+        return state.SkipWithError("cannot create input file");
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(os::file::size(path));
+    state.SetLabel(backing_name(state.range(0)));
+}
+
+void join(benchmark::State& state)
+{
+    std::string dir = "/var/lib/osal/some/nested/directory";
+    std::string name = "file_name.tar.gz";
+    for (auto _ : state)
+        benchmark::DoNotOptimize(os::file::join(dir, name));
+}
+
+void get_stem(benchmark::State& state)
+{
+    std::string path = "/var/lib/osal/some/nested/directory/file_name.tar.gz";
+    for (auto _ : state)
+        benchmark::DoNotOptimize(os::file::get_stem(path));
+}
+
+void get_stem_arena(benchmark::State& state)
+{
+    std::string path = "/var/lib/osal/some/nested/directory/file_name.tar.gz";
+    auto& a = os::arena::local();
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(os::file::get_stem(path, a).data());
+        a.reset();
+    }
+}
+
+/// Log file names as a large directory would hold them
+const std::vector<std::string>& names()
+{
+    static const std::vector<std::string> n = []() {
+        std::vector<std::string> v;
+        for (int i = 0; i < 100000; i++)
+            v.push_back((i % 3 ? "app-" : "db-") + std::to_string(i) + (i % 5 ? ".log" : ".log.gz"));
+        return v;
+    }();
+    return n;
+}
+
+void glob_filter(benchmark::State& state)
+{
+    os::file::glob_pattern pattern("app-*.{log,txt}");
+    for (auto _ : state)
+    {
+        std::size_t matches = 0;
+        for (auto& name : names())
+            matches += pattern.match(name);
+        benchmark::DoNotOptimize(matches);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(names().size()));
+}
+
+/// The std::regex filter glob_filter replaces
+void regex_filter(benchmark::State& state)
+{
+    std::regex pattern("app-.*\\.(log|txt)");
+    for (auto _ : state)
+    {
+        std::size_t matches = 0;
+        for (auto& name : names())
+            matches += std::regex_match(name, pattern);
+        benchmark::DoNotOptimize(matches);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(names().size()));
+}
+
+void get_filename(benchmark::State& state)
+{
+    std::string path = "/var/lib/osal/some/nested/directory/file_name.tar.gz";
+    for (auto _ : state)
+        benchmark::DoNotOptimize(os::file::get_filename(path));
+}
+
+} // namespace
+
+BENCHMARK(dump)->Apply(file_sizes);
+BENCHMARK(read)->Apply(file_sizes);
+BENCHMARK(copy_file)->Apply(file_sizes);
+BENCHMARK(list_dir)->Apply(dir_sizes);
+BENCHMARK(list_dir_arena)->Apply(dir_sizes);
+BENCHMARK(disk_usage)->Apply(dir_sizes);
+BENCHMARK(copy_tree)->Apply(dir_sizes);
+BENCHMARK(delete_dir)->Apply(dir_sizes);
+BENCHMARK(glob_filter);
+BENCHMARK(regex_filter);
+BENCHMARK(size)->Arg(tmpfs)->Arg(disk)->ArgName("backing");
+BENCHMARK(join);
+BENCHMARK(get_stem);
+BENCHMARK(get_stem_arena);
+BENCHMARK(get_filename);
@@ -0,0 +1,209 @@
+#include "osal/os.h"
+#include "osal/queue.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <thread>
+#include <vector>
+
+namespace {
+
+/// What services do today: a std::list guarded by a thread_synchronizer
+class locked_list {
+public:
+    explicit locked_list(std::size_t) {}
+
+    bool try_push(uint64_t v)
+    {
+        if (auto lock = m_sync.lock())
+        {
+            m_items.push_back(v);
+            return true;
+        }
+        return false;
+    }
+
+    bool try_pop(uint64_t& v)
+    {
+        if (auto lock = m_sync.lock())
+        {
+            if (m_items.empty())
+                return false;
+            v = m_items.front();
+            m_items.pop_front();
+            return true;
+        }
+        return false;
+    }
+
+private:
+    os::thread_synchronizer m_sync;
+    std::list<uint64_t> m_items;
+};
+
+constexpr std::size_t capacity = 1024;
+constexpr uint64_t items_per_iteration = 1 << 18;
+constexpr std::size_t batch = 64;
+
+/// Moves items_per_iteration items from range(0) producers to range(1) consumers
+template <typename Q>
+void transfer(benchmark::State& state)
+{
+    auto producers = static_cast<uint64_t>(state.range(0));
+    auto consumers = static_cast<uint64_t>(state.range(1));
+    auto per_producer = items_per_iteration / producers;
+
+    for (auto _ : state)
+    {
+        Q q(capacity);
+        std::atomic<uint64_t> remaining{per_producer * producers};
+        std::vector<std::thread> threads;
+
+        for (uint64_t p = 0; p < producers; p++)
+        {
+            threads.emplace_back([&q, per_producer]() {
+                for (uint64_t i = 0; i < per_producer; i++)
+                {
+                    while (!q.try_push(i))
+                        std::this_thread::yield();
+                }
+            });
+        }
+        for (uint64_t c = 0; c < consumers; c++)
+        {
+            threads.emplace_back([&q, &remaining]() {
+                uint64_t v;
+                while (remaining.load(std::memory_order_relaxed) != 0)
+                {
+                    if (q.try_pop(v))
+                        remaining.fetch_sub(1, std::memory_order_relaxed);
+                    else
+                        std::this_thread::yield();
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * per_producer * producers));
+}
+
+/// Same as transfer with 64 item batches on both sides
+template <typename Q>
+void transfer_batch(benchmark::State& state)
+{
+    auto producers = static_cast<uint64_t>(state.range(0));
+    auto consumers = static_cast<uint64_t>(state.range(1));
+    auto per_producer = items_per_iteration / producers;
+
+    for (auto _ : state)
+    {
+        Q q(capacity);
+        std::atomic<uint64_t> remaining{per_producer * producers};
+        std::vector<std::thread> threads;
+
+        for (uint64_t p = 0; p < producers; p++)
+        {
+            threads.emplace_back([&q, per_producer]() {
+                uint64_t items[batch] = {};
+                for (uint64_t i = 0; i < per_producer;)
+                {
+                    auto n = static_cast<std::size_t>(std::min<uint64_t>(batch, per_producer - i));
+                    auto pushed = q.try_push(items, n);
+                    if (pushed == 0)
+                        std::this_thread::yield();
+                    i += pushed;
+                }
+            });
+        }
+        for (uint64_t c = 0; c < consumers; c++)
+        {
+            threads.emplace_back([&q, &remaining]() {
+                uint64_t items[batch];
+                while (remaining.load(std::memory_order_relaxed) != 0)
+                {
+                    auto n = q.try_pop(items, batch);
+                    if (n != 0)
+                        remaining.fetch_sub(n, std::memory_order_relaxed);
+                    else
+                        std::this_thread::yield();
+                }
+            });
+        }
+        for (auto& t : threads)
+            t.join();
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * per_producer * producers));
+}
+
+/// Round trip of one item through a pair of queues, reports p50/p99 in addition to the mean
+template <typename Q>
+void ping_pong(benchmark::State& state)
+{
+    Q ping(capacity);
+    Q pong(capacity);
+    std::atomic<bool> done{false};
+
+    std::thread echo([&]() {
+        uint64_t v;
+        while (!done.load(std::memory_order_relaxed))
+        {
+            if (ping.try_pop(v))
+            {
+                while (!pong.try_push(v))
+                {
+                }
+            }
+        }
+    });
+
+    std::vector<double> samples;
+    samples.reserve(1 << 20);
+    uint64_t v = 0;
+    for (auto _ : state)
+    {
+        auto start = std::chrono::steady_clock::now();
+        while (!ping.try_push(v))
+        {
+        }
+        while (!pong.try_pop(v))
+        {
+        }
+        auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (samples.size() < samples.capacity())
+            samples.push_back(ns);
+    }
+    done = true;
+    echo.join();
+
+    if (!samples.empty())
+    {
+        std::sort(samples.begin(), samples.end());
+        state.counters["p50_ns"] = samples[samples.size() / 2];
+        state.counters["p99_ns"] = samples[samples.size() * 99 / 100];
+    }
+}
+
+void thread_counts(benchmark::internal::Benchmark* b)
+{
+    for (int p : {1, 2, 4})
+    {
+        for (int c : {1, 2, 4})
+            b->Args({p, c});
+    }
+    b->ArgNames({"producers", "consumers"});
+    b->UseRealTime();
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(transfer, os::spsc_queue<uint64_t>)->Args({1, 1})->ArgNames({"producers", "consumers"})->UseRealTime();
+BENCHMARK_TEMPLATE(transfer, os::mpmc_queue<uint64_t>)->Apply(thread_counts);
+BENCHMARK_TEMPLATE(transfer, locked_list)->Apply(thread_counts);
+BENCHMARK_TEMPLATE(transfer_batch, os::spsc_queue<uint64_t>)->Args({1, 1})->ArgNames({"producers", "consumers"})->UseRealTime();
+BENCHMARK_TEMPLATE(transfer_batch, os::mpmc_queue<uint64_t>)->Apply(thread_counts);
+BENCHMARK_TEMPLATE(ping_pong, os::spsc_queue<uint64_t>)->UseRealTime();
+BENCHMARK_TEMPLATE(ping_pong, os::mpmc_queue<uint64_t>)->UseRealTime();
+BENCHMARK_TEMPLATE(ping_pong, locked_list)->UseRealTime();
@@ -0,0 +1,286 @@
+#include "osal/clock.h"
+#include "osal/histogram.h"
+#include "osal/os.h"
+#include "osal/thread.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread scaling of the lock primitives. Every case runs range(0) threads that repeatedly spend
+// range(2) ns outside the lock, acquire it, spend range(1) ns inside and release it. With
+// range(3) set thread i is pinned to the i-th allowed cpu, wrapping around. Reported per case:
+//   ops/s      critical sections completed per second, all threads
+//   fairness   Jain's index of per-thread op counts, 1 when every thread got an equal share
+//   min_share  ops of the least served thread relative to an equal share
+//   max_share  ops of the most served thread relative to an equal share
+//   p50/p99/p999/max_ns   time from wanting the lock to holding it
+//
+// OSAL_BENCH_MAX_THREADS overrides the largest thread count (default twice the cpu count).
+//
+// A primitive is plugged in with an adapter: a default constructible type with a nested worker,
+// constructed once per thread from the adapter, that has
+//     template <typename Outside, typename Critical> void op(Outside outside, Critical critical)
+// running outside() without the lock and critical() with it held. Add a BENCHMARK_TEMPLATE line
+// for the adapter at the bottom to compare it against the others.
+
+namespace {
+
+/// Baseline
+struct std_mutex {
+    struct worker {
+        explicit worker(std_mutex& a)
+            : m(a.m)
+        {}
+
+        template <typename Outside, typename Critical>
+        void op(Outside outside, Critical critical)
+        {
+            outside();
+            std::lock_guard<std::mutex> lock(m);
+            critical();
+        }
+
+        std::mutex& m;
+    };
+
+    std::mutex m;
+};
+
+/// Baseline
+struct std_recursive_mutex {
+    struct worker {
+        explicit worker(std_recursive_mutex& a)
+            : m(a.m)
+        {}
+
+        template <typename Outside, typename Critical>
+        void op(Outside outside, Critical critical)
+        {
+            outside();
+            std::lock_guard<std::recursive_mutex> lock(m);
+            critical();
+        }
+
+        std::recursive_mutex& m;
+    };
+
+    std::recursive_mutex m;
+};
+
+struct os_recursive_mutex {
+    struct worker {
+        explicit worker(os_recursive_mutex& a)
+            : m(a.m)
+        {}
+
+        template <typename Outside, typename Critical>
+        void op(Outside outside, Critical critical)
+        {
+            outside();
+            os::recursive_mutex_lock lock(m);
+            critical();
+        }
+
+        os::recursive_mutex& m;
+    };
+
+    os::recursive_mutex m{"bench.recursive_mutex"};
+};
+
+struct os_thread_synchronizer {
+    struct worker {
+        explicit worker(os_thread_synchronizer& a)
+            : sync(a.sync)
+        {}
+
+        template <typename Outside, typename Critical>
+        void op(Outside outside, Critical critical)
+        {
+            outside();
+            if (auto lock = sync.lock())
+                critical();
+        }
+
+        os::thread_synchronizer& sync;
+    };
+
+    os::thread_synchronizer sync{"bench.thread_synchronizer"};
+};
+
+/// Service loop style: every thread holds the lock and steps out of it with temporary_unlock
+struct os_temporary_unlock {
+    struct worker {
+        explicit worker(os_temporary_unlock& a)
+            : sync(a.sync)
+            , lock(sync.lock())
+        {}
+
+        template <typename Outside, typename Critical>
+        void op(Outside outside, Critical critical)
+        {
+            {
+                os::temporary_unlock unlock(sync);
+                outside();
+            }
+            critical();
+        }
+
+        os::thread_synchronizer& sync;
+        os::recursive_mutex_lock lock;
+    };
+
+    os::thread_synchronizer sync{"bench.temporary_unlock"};
+};
+
+constexpr uint64_t round_ns = 50000000;
+
+void pin_to_cpu(std::size_t index)
+{
+    static const auto cpus = os::this_thread::affinity();
+    if (!cpus.empty())
+        os::this_thread::pin(cpus[index % cpus.size()]);
+}
+
+void spin(uint64_t cycles)
+{
+    if (cycles == 0)
+        return;
+    auto until = os::clock::cycles() + cycles;
+    while (os::clock::cycles() < until)
+    {
+    }
+}
+
+struct thread_result {
+    uint64_t ops{0};
+    os::histogram latency; // cycles
+};
+
+template <typename Primitive>
+void contention(benchmark::State& state)
+{
+    auto threads  = static_cast<std::size_t>(state.range(0));
+    auto critical = os::clock::ns_to_cycles(static_cast<uint64_t>(state.range(1)));
+    auto outside  = os::clock::ns_to_cycles(static_cast<uint64_t>(state.range(2)));
+    auto pin      = state.range(3) != 0;
+
+    Primitive primitive;
+    os::histogram latency;
+    uint64_t total_ops = 0;
+    double fairness = 0, min_share = 0, max_share = 0;
+
+    for (auto _ : state)
+    {
+        std::vector<thread_result> results(threads);
+        std::atomic<bool> go{false};
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> pool;
+        for (std::size_t i = 0; i < threads; i++)
+        {
+            pool.emplace_back([&, i]() {
+                if (pin)
+                    pin_to_cpu(i);
+                auto& r = results[i];
+                typename Primitive::worker w(primitive);
+                while (!go.load(std::memory_order_acquire))
+                    std::this_thread::yield();
+
+                uint64_t want = 0;
+                while (!stop.load(std::memory_order_relaxed))
+                {
+                    w.op(
+                        [&]() {
+                            spin(outside);
+                            want = os::clock::cycles();
+                        },
+                        [&]() {
+                            r.latency.record(os::clock::cycles() - want);
+                            spin(critical);
+                        });
+                    r.ops++;
+                }
+            });
+        }
+
+        auto start = os::clock::monotonic_ns();
+        go.store(true, std::memory_order_release);
+        os::sleep_for_ns(round_ns);
+        stop.store(true);
+        auto elapsed = os::clock::monotonic_ns() - start;
+        for (auto& t : pool)
+            t.join();
+        state.SetIterationTime(static_cast<double>(elapsed) / 1e9);
+
+        uint64_t ops = 0;
+        double squares = 0;
+        uint64_t lo = UINT64_MAX, hi = 0;
+        for (auto& r : results)
+        {
+            ops += r.ops;
+            squares += static_cast<double>(r.ops) * static_cast<double>(r.ops);
+            lo = std::min(lo, r.ops);
+            hi = std::max(hi, r.ops);
+            latency.merge(r.latency);
+        }
+        total_ops += ops;
+        auto fair = static_cast<double>(ops) / static_cast<double>(threads);
+        if (ops > 0)
+        {
+            fairness += static_cast<double>(ops) * static_cast<double>(ops) / (static_cast<double>(threads) * squares);
+            min_share += static_cast<double>(lo) / fair;
+            max_share += static_cast<double>(hi) / fair;
+        }
+    }
+
+    auto rounds = static_cast<double>(state.iterations());
+    state.counters["ops/s"]     = benchmark::Counter(static_cast<double>(total_ops), benchmark::Counter::kIsRate);
+    state.counters["fairness"]  = fairness / rounds;
+    state.counters["min_share"] = min_share / rounds;
+    state.counters["max_share"] = max_share / rounds;
+    state.counters["p50_ns"]    = static_cast<double>(os::clock::cycles_to_ns(latency.percentile(0.5)));
+    state.counters["p99_ns"]    = static_cast<double>(os::clock::cycles_to_ns(latency.percentile(0.99)));
+    state.counters["p999_ns"]   = static_cast<double>(os::clock::cycles_to_ns(latency.percentile(0.999)));
+    state.counters["max_ns"]    = static_cast<double>(os::clock::cycles_to_ns(latency.max()));
+}
+
+void sweep(benchmark::internal::Benchmark* b)
+{
+    int64_t cpus = os::cpu_count();
+    auto env     = std::getenv("OSAL_BENCH_MAX_THREADS");
+    int64_t max  = env && *env ? std::max(1ll, std::atoll(env)) : 2 * cpus;
+
+    std::vector<int64_t> counts;
+    for (int64_t t = 1; t <= max; t *= 2)
+        counts.push_back(t);
+    for (auto t : {cpus, max})
+    {
+        if (std::find(counts.begin(), counts.end(), t) == counts.end() && t <= max)
+            counts.push_back(t);
+    }
+    std::sort(counts.begin(), counts.end());
+
+    for (auto threads : counts)
+    {
+        for (int64_t critical : {0, 250, 2000})
+        {
+            for (int64_t outside : {0, 4000})
+            {
+                for (int64_t pin : {0, 1})
+                    b->Args({threads, critical, outside, pin});
+            }
+        }
+    }
+    b->ArgNames({"threads", "cs_ns", "outside_ns", "pin"})->UseManualTime()->Unit(benchmark::kMillisecond);
+}
+
+} // namespace
+
+BENCHMARK_TEMPLATE(contention, std_mutex)->Apply(sweep);
+BENCHMARK_TEMPLATE(contention, std_recursive_mutex)->Apply(sweep);
+BENCHMARK_TEMPLATE(contention, os_recursive_mutex)->Apply(sweep);
+BENCHMARK_TEMPLATE(contention, os_thread_synchronizer)->Apply(sweep);
+BENCHMARK_TEMPLATE(contention, os_temporary_unlock)->Apply(sweep);
@@ -0,0 +1,89 @@
+#include "osal/cpu_features.h"
+#include "osal/text.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <string>
+
+namespace {
+
+/// Log-like text, lines of 40 to 160 bytes
+const std::string& corpus()
+{
+    static const std::string text = []() {
+        std::string s;
+        uint32_t seed = 1;
+        while (s.size() < (64u << 20))
+        {
+            seed = seed * 1664525u + 1013904223u;
+            s.append(40 + (seed >> 8) % 120, 'a' + static_cast<char>((seed >> 16) % 26));
+            s.push_back('\n');
+        }
+        return s;
+    }();
+    return text;
+}
+
+void byte_loop(benchmark::State& state)
+{
+    auto& text = corpus();
+    for (auto _ : state)
+    {
+        std::size_t lines = 0, start = 0;
+        for (std::size_t i = 0; i < text.size(); i++)
+        {
+            if (text[i] == '\n')
+            {
+                benchmark::DoNotOptimize(text.data() + start);
+                start = i + 1;
+                lines++;
+            }
+        }
+        benchmark::DoNotOptimize(lines);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+void line_splitter(benchmark::State& state)
+{
+    auto& text       = corpus();
+    const auto chunk = static_cast<std::size_t>(state.range(0));
+    for (auto _ : state)
+    {
+        os::text::line_splitter lines;
+        os::string_ref line;
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < text.size(); i += chunk)
+        {
+            lines.feed(os::string_ref(text.data() + i, std::min(chunk, text.size() - i)));
+            while (lines.next(line))
+                count++;
+        }
+        benchmark::DoNotOptimize(count);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+/// Scan with the kernel of tier range(0), tiers above the host are skipped
+void find_byte(benchmark::State& state)
+{
+    auto tier = static_cast<os::simd_tier>(state.range(0));
+    if (static_cast<int>(tier) > static_cast<int>(os::host_tier()))
+    {
+        state.SkipWithError("tier not supported by this CPU");
+        return;
+    }
+    os::force_tier(tier);
+    state.SetLabel(os::tier_name(tier));
+
+    auto& text = corpus();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(os::text::find_byte(text.data(), text.data() + text.size(), '\0'));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+    os::clear_forced_tier();
+}
+
+} // namespace
+
+BENCHMARK(byte_loop)->Unit(benchmark::kMillisecond);
+BENCHMARK(line_splitter)->Arg(64 << 10)->Arg(1 << 20)->Arg(64 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK(find_byte)->DenseRange(0, static_cast<int>(os::simd_tier::count) - 1)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,143 @@
+// arena.h
+//
+
+#ifndef OSAL_ARENA_H
+#define OSAL_ARENA_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace os {
+
+/// @brief Non-owning view of characters
+///
+/// Views handed out by an arena are null terminated and live until the arena is reset.
+class string_ref {
+public:
+    string_ref() = default;
+    string_ref(const char* s)
+        : m_data(s)
+        , m_size(s ? std::strlen(s) : 0)
+    {}
+    string_ref(const char* s, std::size_t size)
+        : m_data(s)
+        , m_size(size)
+    {}
+    string_ref(const std::string& s)
+        : m_data(s.data())
+        , m_size(s.size())
+    {}
+
+    const char* data() const { return m_data; }
+    std::size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    const char* begin() const { return m_data; }
+    const char* end() const { return m_data + m_size; }
+    char operator[](std::size_t i) const { return m_data[i]; }
+    std::string str() const { return std::string(m_data, m_size); }
+
+    bool operator==(const string_ref& other) const
+    {
+        return m_size == other.m_size && (m_size == 0 || std::memcmp(m_data, other.m_data, m_size) == 0);
+    }
+    bool operator!=(const string_ref& other) const { return !(*this == other); }
+
+private:
+    const char* m_data{""};
+    std::size_t m_size{0};
+};
+
+/// @brief Bump allocator for short-lived data that is released all at once
+///
+/// Allocations are carved out of chained chunks and never freed individually. reset() makes
+/// every chunk reusable, so a request loop that resets the arena at the end of each request
+/// stops allocating once the chunks cover its peak. Not thread safe, use one arena per thread.
+/// @code
+///     auto& a = os::arena::local();
+///     for (auto name : os::file::list_dir(dir, a))
+///         ...
+///     a.reset();
+class arena {
+public:
+    /// @param chunk_size Bytes per chunk, larger allocations get a chunk of their own
+    explicit arena(std::size_t chunk_size = 16 * 1024);
+    arena(const arena& other) = delete;
+    arena(arena&& other) noexcept = delete;
+    arena& operator=(const arena& other) = delete;
+    arena& operator=(arena&& other) noexcept = delete;
+    ~arena();
+
+    /// @brief The calling thread's arena
+    static arena& local();
+
+    /// @param alignment Power of two
+    void* allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+    /// @brief Null terminated copy of @p s
+    string_ref copy(string_ref s);
+
+    /// @brief Forget every allocation, keeping the chunks for reuse
+    void reset();
+
+    /// @brief Bytes handed out since the last reset
+    std::size_t used() const { return m_used; }
+
+    /// @brief Chunks obtained from the heap
+    std::size_t chunks() const { return m_chunks; }
+
+private:
+    struct chunk {
+        chunk* next;
+        std::size_t size;
+        std::size_t offset;
+    };
+
+    chunk* m_first{nullptr};
+    chunk* m_current{nullptr};
+    std::size_t m_chunk_size;
+    std::size_t m_used{0};
+    std::size_t m_chunks{0};
+};
+
+/// @brief Standard allocator handing out arena memory, deallocate is a no-op
+template <typename T>
+class arena_allocator {
+public:
+    using value_type = T;
+
+    arena_allocator(arena& a)
+        : m_arena(&a)
+    {}
+    template <typename U>
+    arena_allocator(const arena_allocator<U>& other)
+        : m_arena(other.m_arena)
+    {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(m_arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, std::size_t) {}
+
+    template <typename U>
+    bool operator==(const arena_allocator<U>& other) const
+    {
+        return m_arena == other.m_arena;
+    }
+    template <typename U>
+    bool operator!=(const arena_allocator<U>& other) const
+    {
+        return m_arena != other.m_arena;
+    }
+
+private:
+    template <typename U>
+    friend class arena_allocator;
+    arena* m_arena;
+};
+
+template <typename T>
+using arena_vector = std::vector<T, arena_allocator<T>>;
+
+} // namespace os
+
+#endif // OSAL_ARENA_H
@@ -0,0 +1,74 @@
+// clock.h
+//
+
+#ifndef OSAL_CLOCK_H
+#define OSAL_CLOCK_H
+
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define OSAL_HAS_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define OSAL_HAS_TSC 1
+#else
+#define OSAL_HAS_TSC 0
+#endif
+
+namespace os {
+namespace clock {
+
+/// @brief Nanoseconds on the monotonic clock, unaffected by wall clock changes
+uint64_t monotonic_ns();
+
+/// @brief Monotonic time with tick (typically 1-4 ms) resolution, cheaper than monotonic_ns
+///
+/// Falls back to monotonic_ns where the platform has no coarse clock.
+uint64_t monotonic_coarse_ns();
+
+/// @brief Nanoseconds since the Unix epoch
+uint64_t realtime_ns();
+
+/// @brief Raw cycle counter (TSC on x86), monotonic_ns elsewhere
+///
+/// Costs a few nanoseconds. Convert with cycles_to_ns, which is only meaningful on hosts with
+/// an invariant TSC (see tsc_invariant).
+inline uint64_t cycles()
+{
+#if OSAL_HAS_TSC
+    return __rdtsc();
+#else
+    return monotonic_ns();
+#endif
+}
+
+/// @brief True when the cycle counter ticks at a constant rate across cores and power states
+bool tsc_invariant();
+
+/// @brief Measure the cycle counter against the monotonic clock
+///
+/// Runs automatically on the first conversion. Calling it at startup keeps the ~10 ms
+/// measurement out of the hot path.
+void calibrate();
+
+/// @brief Cycle counter ticks per nanosecond
+double cycles_per_ns();
+
+uint64_t cycles_to_ns(uint64_t cycles);
+uint64_t ns_to_cycles(uint64_t ns);
+
+constexpr uint64_t us_to_ns(uint64_t us) { return us * 1000; }
+constexpr uint64_t ms_to_ns(uint64_t ms) { return ms * 1000000; }
+constexpr uint64_t s_to_ns(uint64_t s) { return s * 1000000000; }
+constexpr uint64_t ns_to_us(uint64_t ns) { return ns / 1000; }
+constexpr uint64_t ns_to_ms(uint64_t ns) { return ns / 1000000; }
+constexpr uint64_t ns_to_s(uint64_t ns) { return ns / 1000000000; }
+
+/// @brief @p now + @p ns, saturated so that huge timeouts mean "never" instead of wrapping
+constexpr uint64_t deadline_after(uint64_t now, uint64_t ns) { return ns > UINT64_MAX - now ? UINT64_MAX : now + ns; }
+
+} // namespace clock
+} // namespace os
+
+#endif // OSAL_CLOCK_H
@@ -0,0 +1,87 @@
+// copy_tree.h
+//
+
+#ifndef OSAL_COPY_TREE_H
+#define OSAL_COPY_TREE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace os {
+
+class thread_pool;
+
+namespace file {
+
+/// @brief How copy_tree shares files that are unchanged since the link_dest snapshot
+enum class snapshot_link {
+    hardlink, ///< link() to the old copy, costs one directory entry
+    reflink,  ///< Clone the old copy's extents, costs nothing until either side is written
+};
+
+struct copy_options {
+    /// Put the source permission bits on every copy
+    bool preserve_mode{true};
+    /// Put the source access and modification times on every copy
+    bool preserve_times{true};
+    /// Leave holes where the source has them instead of writing zeros
+    bool sparse{true};
+    /// Share extents with the source where the filesystem can (FICLONE), copy where it cannot
+    bool reflink{true};
+    /// Replace files that already exist below the destination
+    bool overwrite{true};
+    /// @brief Previous snapshot of the same source, empty for a plain copy
+    ///
+    /// A regular file whose counterpart below link_dest has the same size, modification time
+    /// and mode is linked to that counterpart instead of copied, like rsync --link-dest.
+    std::string link_dest;
+    snapshot_link link{snapshot_link::hardlink};
+    /// Copy on this pool instead of a temporary one
+    thread_pool* pool{nullptr};
+    /// Workers of the temporary pool, 0 uses the hardware concurrency
+    std::size_t threads{0};
+};
+
+struct copy_report {
+    uint64_t files{0};    ///< Regular files written, linked or cloned
+    uint64_t dirs{0};     ///< Directories created, the root included
+    uint64_t symlinks{0}; ///< Symbolic links recreated, never followed
+    uint64_t linked{0};   ///< Files taken from link_dest instead of the source
+    uint64_t cloned{0};   ///< Files whose data was shared by reflink
+    uint64_t bytes{0};    ///< Data bytes actually copied, holes and shared extents excluded
+    uint64_t errors{0};   ///< Entries that could not be read, created or written
+
+    copy_report& operator+=(const copy_report& other)
+    {
+        files += other.files;
+        dirs += other.dirs;
+        symlinks += other.symlinks;
+        linked += other.linked;
+        cloned += other.cloned;
+        bytes += other.bytes;
+        errors += other.errors;
+        return *this;
+    }
+};
+
+/// @brief Copy the tree below @p src to @p dst in parallel
+///
+/// Workers take directories from a shared stack. Each file is copied inside the kernel, by
+/// reflink where possible and copy_file_range otherwise, skipping holes with SEEK_DATA. Directory
+/// permissions and times are applied last, deepest first, so they survive their entries being
+/// written. Special files are recreated with mknod; ownership is left to the caller. An error on
+/// one entry is counted and the rest of the tree is still copied. A @p dst below @p src is left
+/// out of the copy, so a tree can be snapshotted into one of its own directories; @p dst being
+/// @p src itself is an error. Not available on Windows, where the report holds one error.
+/// @code
+///     os::file::copy_options opt;
+///     opt.link_dest = "/backup/2024-05-01";
+///     auto report = os::file::copy_tree("/srv/data", "/backup/2024-05-02", opt);
+///     // report.linked files cost no data, report.bytes is what changed
+copy_report copy_tree(const std::string& src, const std::string& dst, const copy_options& options = copy_options());
+
+} // namespace file
+} // namespace os
+
+#endif // OSAL_COPY_TREE_H
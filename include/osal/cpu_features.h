@@ -0,0 +1,167 @@
+// cpu_features.h
+//
+
+#ifndef OSAL_CPU_FEATURES_H
+#define OSAL_CPU_FEATURES_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define OSAL_SIMD_X86 1
+#else
+#define OSAL_SIMD_X86 0
+#endif
+
+/// @brief Compile one function for an instruction set the rest of the build does not assume,
+///        e.g. OSAL_TARGET("avx2"). MSVC needs no attribute to use the intrinsics.
+#if defined(__GNUC__) || defined(__clang__)
+#define OSAL_TARGET(isa) __attribute__((target(isa)))
+#else
+#define OSAL_TARGET(isa)
+#endif
+
+namespace os {
+
+/// @brief Instruction set extensions of the host CPU
+///
+/// AVX and AVX-512 are only reported when the OS also saves their registers.
+struct cpu_features {
+    bool sse2;
+    bool sse3;
+    bool ssse3;
+    bool sse41;
+    bool sse42;
+    bool popcnt;
+    bool avx;
+    bool avx2;
+    bool fma;
+    bool bmi1;
+    bool bmi2;
+    bool avx512f;
+    bool avx512bw;
+    bool avx512vl;
+    bool neon;
+
+    /// @brief Detected once, then cached
+    static const cpu_features& host();
+};
+
+/// @brief Kernel generations, each tier implies the ones below it
+enum class simd_tier {
+    scalar,
+    sse2,
+    sse42,
+    avx2,   ///< AVX2, FMA, BMI1 and BMI2
+    avx512, ///< AVX-512 F, BW and VL
+    count
+};
+
+const char* tier_name(simd_tier t);
+
+/// @brief Highest tier the host supports
+simd_tier host_tier();
+
+/// @brief Highest tier dispatchers may pick, host_tier() unless forced lower
+///
+/// The environment variable OSAL_SIMD_TIER (scalar, sse2, sse42, avx2, avx512) sets the initial
+/// cap, which lets a single binary be benchmarked at every tier.
+simd_tier active_tier();
+
+/// @brief Cap every dispatcher at @p t, for tests and benchmarks
+///
+/// Tiers above host_tier() are clamped to it. Kernels are chosen again on their next call.
+void force_tier(simd_tier t);
+
+/// @brief Undo force_tier() and OSAL_SIMD_TIER
+void clear_forced_tier();
+
+namespace detail {
+/// Bumped by force_tier() and clear_forced_tier() so dispatchers pick again
+extern std::atomic<uint32_t> tier_generation;
+} // namespace detail
+
+/// @brief Picks the best kernel of a function for the host, like GCC's target_clones or an
+///        ifunc resolver but portable and overridable with force_tier()
+///
+/// The choice is made on the first call and cached, later calls cost two relaxed loads.
+/// @code
+///     static const os::dispatch<count_fn> count{
+///         {os::simd_tier::scalar, count_scalar},
+///         {os::simd_tier::avx2, count_avx2}};
+///     return count.get()(data, size);
+template <typename Fn>
+class dispatch {
+public:
+    struct kernel {
+        simd_tier tier;
+        Fn fn;
+    };
+
+    /// @param kernels Must include a simd_tier::scalar kernel
+    dispatch(std::initializer_list<kernel> kernels)
+    {
+        for (auto& k : kernels)
+        {
+            if (m_count < static_cast<std::size_t>(simd_tier::count))
+                m_kernels[m_count++] = k;
+        }
+    }
+    dispatch(const dispatch& other) = delete;
+    dispatch(dispatch&& other) noexcept = delete;
+    dispatch& operator=(const dispatch& other) = delete;
+    dispatch& operator=(dispatch&& other) noexcept = delete;
+    ~dispatch() = default;
+
+    Fn get() const
+    {
+        auto generation = detail::tier_generation.load(std::memory_order_relaxed);
+        if (m_generation.load(std::memory_order_acquire) == generation + 1)
+            return m_fn.load(std::memory_order_relaxed);
+        auto fn = pick(active_tier());
+        m_fn.store(fn, std::memory_order_relaxed);
+        m_generation.store(generation + 1, std::memory_order_release);
+        return fn;
+    }
+
+    /// @brief Kernel for @p tier or the best one below it, ignoring what the host supports
+    Fn pick(simd_tier tier) const
+    {
+        Fn best       = nullptr;
+        int best_rank = -1;
+        for (std::size_t i = 0; i < m_count; i++)
+        {
+            auto rank = static_cast<int>(m_kernels[i].tier);
+            if (rank <= static_cast<int>(tier) && rank > best_rank)
+            {
+                best      = m_kernels[i].fn;
+                best_rank = rank;
+            }
+        }
+        return best;
+    }
+
+    /// @brief Tier of the kernel get() returns
+    simd_tier tier() const
+    {
+        auto fn = get();
+        for (std::size_t i = 0; i < m_count; i++)
+        {
+            if (m_kernels[i].fn == fn)
+                return m_kernels[i].tier;
+        }
+        return simd_tier::scalar;
+    }
+
+private:
+    kernel m_kernels[static_cast<std::size_t>(simd_tier::count)]{};
+    std::size_t m_count{0};
+    mutable std::atomic<Fn> m_fn{nullptr};
+    mutable std::atomic<uint32_t> m_generation{0}; // tier_generation + 1 when m_fn is current
+};
+
+} // namespace os
+
+#endif // OSAL_CPU_FEATURES_H
@@ -0,0 +1,74 @@
+// disk_usage.h
+//
+
+#ifndef OSAL_DISK_USAGE_H
+#define OSAL_DISK_USAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace os {
+
+class thread_pool;
+
+namespace file {
+
+/// @brief Space taken by a directory tree
+struct usage {
+    uint64_t apparent_bytes{0};  ///< Sum of file sizes, what a reader would see
+    uint64_t allocated_bytes{0}; ///< Blocks on disk, less than apparent for sparse or compressed files
+    uint64_t files{0};           ///< Everything that is not a directory, symlinks included
+    uint64_t dirs{0};
+    uint64_t errors{0}; ///< Entries or directories that could not be read
+
+    usage& operator+=(const usage& other)
+    {
+        apparent_bytes += other.apparent_bytes;
+        allocated_bytes += other.allocated_bytes;
+        files += other.files;
+        dirs += other.dirs;
+        errors += other.errors;
+        return *this;
+    }
+};
+
+struct usage_options {
+    /// Count a file with several hard links once, like du
+    bool count_links_once{true};
+    /// Do not descend into directories on other filesystems, like du -x
+    bool one_file_system{false};
+    /// Also report every immediate subdirectory of the root on its own
+    bool breakdown{false};
+    /// Walk on this pool instead of a temporary one
+    thread_pool* pool{nullptr};
+    /// Workers of the temporary pool, 0 uses the hardware concurrency
+    std::size_t threads{0};
+};
+
+struct usage_report {
+    usage total;
+    /// Immediate subdirectories by name with the usage below them, sorted by name. Only filled
+    /// with usage_options::breakdown.
+    std::vector<std::pair<std::string, usage>> subdirs;
+};
+
+/// @brief Walk the tree below @p path in parallel and add up what it holds
+///
+/// Every entry costs one statx relative to its directory, nothing else; symbolic links are
+/// counted but not followed. Workers take directories from a shared stack, so wide and deep
+/// trees both keep the pool busy. Not available on Windows, where the report holds one error.
+/// @code
+///     os::file::usage_options opt;
+///     opt.breakdown = true;
+///     auto report = os::file::disk_usage("/srv/data", opt);
+///     for (auto& sub : report.subdirs)
+///         printf("%12llu %s\n", (unsigned long long)sub.second.allocated_bytes, sub.first.c_str());
+usage_report disk_usage(const std::string& path, const usage_options& options = usage_options());
+
+} // namespace file
+} // namespace os
+
+#endif // OSAL_DISK_USAGE_H
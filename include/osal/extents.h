@@ -0,0 +1,65 @@
+// extents.h
+//
+
+#ifndef OSAL_EXTENTS_H
+#define OSAL_EXTENTS_H
+
+#include "osal/arena.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace os {
+namespace file {
+
+/// @brief A byte range of a file
+struct extent {
+    uint64_t offset;
+    uint64_t size;
+};
+
+/// @brief Reserve disk blocks for [@p offset, @p offset + @p len) of an open file
+///
+/// Blocks reserved in one call are usually contiguous, so a file written after reserving its
+/// final size does not fragment the way growing it write by write does. With @p keep_size the
+/// file size stays as it is and later writes fill the reservation; otherwise the file grows to
+/// cover the range and reads zeros there. Pending stdio output is not affected. @p keep_size
+/// has no default since either choice is right for some callers and surprising for others.
+/// @return false where the filesystem or platform cannot reserve space
+bool preallocate(FILE* fd, uint64_t offset, uint64_t len, bool keep_size);
+
+/// @brief Create @p path if needed and reserve @p size bytes for it, see preallocate(FILE*)
+bool preallocate(const std::string& path, uint64_t size, bool keep_size);
+
+/// @brief Release the blocks of [@p offset, @p offset + @p len), which then read as zeros
+///
+/// The file size does not change. Filesystems free whole blocks and zero the partial ones at
+/// either end, so recycled space in a large data file costs no rewrite.
+/// @return false where the filesystem or platform cannot punch holes
+bool punch_hole(FILE* fd, uint64_t offset, uint64_t len);
+bool punch_hole(const std::string& path, uint64_t offset, uint64_t len);
+
+/// @brief The ranges of @p path that hold data, in order
+///
+/// Found with SEEK_DATA and SEEK_HOLE. Where those are not supported the whole file is one
+/// extent. Empty if the file cannot be opened or holds no data.
+std::vector<extent> data_extents(const std::string& path);
+
+/// @brief Read only the data of a sparse file
+///
+/// Calls @p fn with each piece of data and its file offset, in order and in pieces of at most
+/// @p chunk bytes. Holes are skipped without being read. The view is valid during the call.
+/// @return false if the file cannot be opened or a read fails
+bool for_each_data(const std::string& path, const std::function<void(uint64_t offset, string_ref data)>& fn,
+                   std::size_t chunk = 1 << 20);
+
+/// @brief Bytes of disk @p path occupies, less than its size when sparse, 0 if it does not exist
+uint64_t allocated_size(const std::string& path);
+
+} // namespace file
+} // namespace os
+
+#endif // OSAL_EXTENTS_H
@@ -0,0 +1,102 @@
+// glob.h
+//
+
+#ifndef OSAL_GLOB_H
+#define OSAL_GLOB_H
+
+#include "osal/arena.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace os {
+namespace file {
+
+/// @brief A shell pattern compiled once and matched many times
+///
+/// Supports @c * and @c ? within one path component, sets such as @c [a-z] and @c [!0-9],
+/// @c ** for any number of directories and brace alternatives such as @c {jpg,png}, which may
+/// nest. Between components @c ** may match zero directories, so @c a/**/z matches @c a/z, but a
+/// trailing @c ** needs at least one: @c a/** matches everything below @c a and not @c a itself. A backslash makes the next character literal. Wildcards do not match a leading dot, so
+/// hidden entries only match a pattern that starts with one. An unclosed @c [ or @c { is
+/// literal. A trailing slash matches directories only.
+///
+/// Braces are expanded and every component is parsed when the pattern is built; match() then
+/// compares without allocating.
+/// @code
+///     os::file::glob_pattern logs("*.{log,log.gz}");
+///     for (auto& name : os::file::list_dir(dir))
+///         if (logs.match(name))
+///             ...
+class glob_pattern {
+public:
+    explicit glob_pattern(string_ref pattern);
+
+    /// @brief Whether the '/' separated @p path matches as a whole
+    bool match(string_ref path) const;
+
+    /// @brief The pattern it was built from
+    const std::string& str() const { return m_pattern; }
+
+private:
+    friend class glob_walker;
+    friend std::vector<std::string> glob(const glob_pattern& pattern);
+
+    /// One character set, 256 bits
+    struct charset {
+        uint64_t bits[4];
+        bool test(unsigned char c) const { return (bits[c >> 6] >> (c & 63)) & 1; }
+        void set(unsigned char c) { bits[c >> 6] |= uint64_t(1) << (c & 63); }
+    };
+
+    struct token {
+        enum kind_t : uint8_t { literal, any_one, any_run, set } kind;
+        uint32_t begin; ///< literal: offset into segment::text, set: index into segment::sets
+        uint32_t size;  ///< literal: length
+    };
+
+    struct segment {
+        enum kind_t : uint8_t {
+            literal,  ///< Plain name, looked up directly instead of listing the directory
+            wildcard, ///< Matched against every entry
+            globstar, ///< ** on its own, any number of directories
+        } kind;
+        std::string text; ///< Unescaped literal characters of all tokens
+        std::vector<token> tokens;
+        std::vector<charset> sets;
+        std::size_t min_size; ///< Characters a match needs at least
+        bool dot_ok;          ///< Starts with a literal dot, so hidden entries may match
+
+        bool match(string_ref name) const;
+    };
+
+    struct alternative {
+        std::vector<segment> segments;
+        bool absolute;
+        bool dir_only;
+    };
+
+    static segment compile_segment(string_ref text);
+    static bool match_from(const alternative& alt, std::size_t seg, string_ref path);
+
+    std::string m_pattern;
+    std::vector<alternative> m_alternatives;
+};
+
+/// @brief Paths matching @p pattern, sorted and without duplicates
+///
+/// Paths are relative to the working directory unless the pattern is absolute, and spelled like
+/// the pattern, e.g. @c logs/2026-01/app-3.log for @c logs/2026-*/app-*.log. Components without
+/// wildcards are looked up directly, so only directories that can still lead to a match are
+/// read; the example lists @c logs and the matching month directories and nothing else. Entries
+/// are classified by their directory entry type and stat only where the filesystem does not
+/// report one. @c ** does not follow symbolic links. Unreadable directories are skipped.
+/// Directories are not read on Windows, where only patterns without wildcards can match.
+std::vector<std::string> glob(const glob_pattern& pattern);
+std::vector<std::string> glob(const std::string& pattern);
+
+} // namespace file
+} // namespace os
+
+#endif // OSAL_GLOB_H
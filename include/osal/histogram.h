@@ -0,0 +1,138 @@
+// histogram.h
+//
+
+#ifndef OSAL_HISTOGRAM_H
+#define OSAL_HISTOGRAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace os {
+
+/// @brief Log-linear histogram of 64-bit values
+///
+/// Every power of two is split into 8 linear buckets, so any recorded value is reported within
+/// 12.5%. Values below 8 are exact. Recording is a handful of instructions and allocation free.
+///
+/// A histogram has a single writer: record() must not be called concurrently, but other threads
+/// may read or merge() it while it is being written.
+class histogram {
+public:
+    static constexpr unsigned sub_bits    = 3;
+    static constexpr unsigned sub_buckets = 1u << sub_bits;
+    static constexpr unsigned bucket_count = (64 - sub_bits + 1) * sub_buckets;
+
+    histogram() { reset(); }
+    histogram(const histogram& other) = delete;
+    histogram& operator=(const histogram& other) = delete;
+
+    void record(uint64_t value)
+    {
+        bump(m_buckets[bucket_of(value)], 1);
+        bump(m_count, 1);
+        bump(m_sum, value);
+        if (value > m_max.load(std::memory_order_relaxed))
+            m_max.store(value, std::memory_order_relaxed);
+    }
+
+    /// @brief Add the contents of @p other, may be called concurrently with other.record()
+    void merge(const histogram& other)
+    {
+        for (unsigned i = 0; i < bucket_count; i++)
+            bump(m_buckets[i], other.m_buckets[i].load(std::memory_order_relaxed));
+        bump(m_count, other.m_count.load(std::memory_order_relaxed));
+        bump(m_sum, other.m_sum.load(std::memory_order_relaxed));
+        auto m = other.m_max.load(std::memory_order_relaxed);
+        if (m > m_max.load(std::memory_order_relaxed))
+            m_max.store(m, std::memory_order_relaxed);
+    }
+
+    void reset()
+    {
+        for (auto& b : m_buckets)
+            b.store(0, std::memory_order_relaxed);
+        m_count.store(0, std::memory_order_relaxed);
+        m_sum.store(0, std::memory_order_relaxed);
+        m_max.store(0, std::memory_order_relaxed);
+    }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t sum() const { return m_sum.load(std::memory_order_relaxed); }
+    uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+
+    /// @brief Upper bound of the bucket holding the @p p quantile (0.0 - 1.0), 0 when empty
+    uint64_t percentile(double p) const
+    {
+        auto total = count();
+        if (total == 0)
+            return 0;
+        auto rank = static_cast<uint64_t>(p * static_cast<double>(total) + 0.5);
+        if (rank == 0)
+            rank = 1;
+
+        uint64_t seen = 0;
+        for (unsigned i = 0; i < bucket_count; i++)
+        {
+            seen += m_buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+            {
+                auto upper = bucket_upper(i);
+                return upper < max() ? upper : max();
+            }
+        }
+        return max();
+    }
+
+    /// @brief Number of values recorded in bucket @p i
+    uint64_t bucket(unsigned i) const { return m_buckets[i].load(std::memory_order_relaxed); }
+
+    /// @brief Largest value that lands in bucket @p i
+    static uint64_t bucket_upper(unsigned i)
+    {
+        if (i < sub_buckets)
+            return i;
+        auto shift = i / sub_buckets - 1;
+        auto lower = static_cast<uint64_t>(sub_buckets + i % sub_buckets) << shift;
+        return lower + ((uint64_t(1) << shift) - 1);
+    }
+
+    static unsigned bucket_of(uint64_t value)
+    {
+        if (value < sub_buckets)
+            return static_cast<unsigned>(value);
+        auto e = log2(value);
+        return (e - sub_bits + 1) * sub_buckets + static_cast<unsigned>((value >> (e - sub_bits)) & (sub_buckets - 1));
+    }
+
+private:
+    static unsigned log2(uint64_t v)
+    {
+#ifdef _MSC_VER
+        unsigned long index;
+        _BitScanReverse64(&index, v);
+        return static_cast<unsigned>(index);
+#else
+        return 63u - static_cast<unsigned>(__builtin_clzll(v));
+#endif
+    }
+
+    /// Single writer, so a relaxed load and store avoids the locked read-modify-write
+    static void bump(std::atomic<uint64_t>& a, uint64_t n)
+    {
+        a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> m_buckets[bucket_count];
+    std::atomic<uint64_t> m_count;
+    std::atomic<uint64_t> m_sum;
+    std::atomic<uint64_t> m_max;
+};
+
+} // namespace os
+
+#endif // OSAL_HISTOGRAM_H
@@ -0,0 +1,96 @@
+// io_metrics.h
+//
+
+#ifndef OSAL_IO_METRICS_H
+#define OSAL_IO_METRICS_H
+
+#include "osal/clock.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace os {
+namespace file {
+namespace metrics {
+
+/// @brief os::file operations that are measured
+///
+/// A call is counted once under its own op, the opens and stats it does internally are not
+/// counted again.
+enum class op {
+    open,
+    read,
+    dump,
+    copy_file,
+    list_dir,
+    delete_dir,
+    is_reg_file,
+    is_dir,
+    size,
+    count
+};
+
+const char* op_name(op o);
+
+struct op_report {
+    op operation;
+    uint64_t calls;
+    uint64_t errors;
+    uint64_t bytes; ///< Bytes read or written, 0 for metadata operations
+    uint64_t latency_total_ns;
+    uint64_t latency_p50_ns;
+    uint64_t latency_p99_ns;
+    uint64_t latency_max_ns;
+};
+
+/// @brief Totals over all threads, one entry per op in enum order
+std::vector<op_report> snapshot();
+
+/// @brief Clear all counters and histograms
+void reset();
+
+/// @brief snapshot() in the Prometheus text exposition format
+/// @param prefix Prepended to every metric name
+std::string prometheus(const std::string& prefix = "osal_file");
+
+namespace detail {
+
+void record(op o, uint64_t start_cycles, uint64_t end_cycles, uint64_t bytes, bool failed);
+
+/// @brief Times the enclosing os::file call and records it on destruction
+///
+/// With OSAL_TRACE the call is also recorded as an os::trace span.
+class scope {
+public:
+    explicit scope(op o)
+        : m_op(o)
+        , m_start(clock::cycles())
+    {}
+    scope(const scope& other) = delete;
+    scope& operator=(const scope& other) = delete;
+    ~scope() { record(m_op, m_start, clock::cycles(), m_bytes, m_failed); }
+
+    void bytes(uint64_t n) { m_bytes = n; }
+    void failed(bool f = true) { m_failed = f; }
+
+    /// @brief Mark failed when @p ok is false and pass it through
+    template <typename T>
+    T result(T ok)
+    {
+        m_failed = !ok;
+        return ok;
+    }
+
+private:
+    op m_op;
+    uint64_t m_start;
+    uint64_t m_bytes{0};
+    bool m_failed{false};
+};
+
+} // namespace detail
+} // namespace metrics
+} // namespace file
+} // namespace os
+
+#endif // OSAL_IO_METRICS_H
@@ -0,0 +1,59 @@
+// lock_stats.h
+//
+
+#ifndef OSAL_LOCK_STATS_H
+#define OSAL_LOCK_STATS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace os {
+namespace lock_stats {
+
+/// @brief Aggregated statistics of every recursive_mutex sharing a name
+struct site_report {
+    std::string name;
+    uint64_t acquires;          ///< Outermost and recursive lock() calls
+    uint64_t contended;         ///< Acquires that found the mutex held by another thread
+    uint64_t temporary_unlocks; ///< temporary_unlock scopes entered
+    uint64_t wait_total_ns;
+    uint64_t wait_p50_ns;
+    uint64_t wait_p99_ns;
+    uint64_t wait_max_ns;
+    uint64_t hold_total_ns; ///< Time from outermost lock to matching unlock
+    uint64_t hold_p50_ns;
+    uint64_t hold_p99_ns;
+    uint64_t hold_max_ns;
+};
+
+/// @brief True when osal was built with OSAL_LOCK_STATS
+///
+/// Without it recursive_mutex carries no instrumentation and the functions below report
+/// nothing.
+bool enabled();
+
+/// @brief Merge the per-thread buffers, sorted by total wait time (highest first)
+std::vector<site_report> snapshot();
+
+/// @brief snapshot() formatted as a table
+std::string report();
+
+/// @brief Clear all recorded statistics
+void reset();
+
+namespace detail {
+
+struct site;
+
+/// @brief Intern a site for mutexes named @p name (nullptr groups unnamed mutexes)
+site* register_site(const char* name);
+void record_acquire(site* s, bool contended, uint64_t wait_cycles);
+void record_hold(site* s, uint64_t hold_cycles);
+void record_temporary_unlock(site* s);
+
+} // namespace detail
+} // namespace lock_stats
+} // namespace os
+
+#endif // OSAL_LOCK_STATS_H
@@ -0,0 +1,163 @@
+// memory.h
+//
+
+#ifndef OSAL_MEMORY_H
+#define OSAL_MEMORY_H
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace os {
+namespace memory {
+
+/// @brief Extra work done by the allocators below, combine with |
+enum option : unsigned {
+    prefault = 1u << 0, ///< Touch every page now instead of faulting on first use
+    lock     = 1u << 1, ///< Keep the pages resident (mlock), the allocation fails if this is refused
+};
+
+/// @brief Releases memory the way it was obtained
+///
+/// Default constructed it calls delete[], which keeps std::unique_ptr<const char[], deleter>
+/// usable for plain new[] allocations.
+class deleter {
+public:
+    deleter() = default;
+    void operator()(const void* p) const;
+
+private:
+    friend class block;
+    enum class kind { array, aligned, mapping };
+
+    deleter(kind k, std::size_t length)
+        : m_kind(k)
+        , m_length(length)
+    {}
+
+    kind m_kind{kind::array};
+    std::size_t m_length{0}; // bytes mapped, for kind::mapping
+};
+
+/// @brief Owns memory from one of the allocators below
+class block {
+public:
+    block() = default;
+    block(const block& other) = delete;
+    block(block&& other) noexcept
+        : m_ptr(std::move(other.m_ptr))
+        , m_size(other.m_size)
+    {
+        other.m_size = 0;
+    }
+    block& operator=(const block& other) = delete;
+    block& operator=(block&& other) noexcept
+    {
+        m_ptr        = std::move(other.m_ptr);
+        m_size       = other.m_size;
+        other.m_size = 0;
+        return *this;
+    }
+    ~block() = default;
+
+    char* data() const { return m_ptr.get(); }
+    std::size_t size() const { return m_size; }
+    explicit operator bool() const { return m_ptr != nullptr; }
+
+    /// @brief Hand the memory to a unique_ptr, the block is empty afterwards
+    std::unique_ptr<char[], deleter> release()
+    {
+        m_size = 0;
+        return std::move(m_ptr);
+    }
+
+private:
+    friend block alloc_heap(std::size_t);
+    friend block alloc_aligned(std::size_t, std::size_t, unsigned);
+    friend block alloc_huge(std::size_t, unsigned);
+    friend block alloc_on_node(std::size_t, unsigned, unsigned);
+    static block aligned(void* p, std::size_t size);
+    static block mapped(void* p, std::size_t size, std::size_t length);
+
+    block(char* p, std::size_t size, deleter d)
+        : m_ptr(p, d)
+        , m_size(size)
+    {}
+
+    std::unique_ptr<char[], deleter> m_ptr;
+    std::size_t m_size{0};
+};
+
+/// @brief Bytes per page
+std::size_t page_size();
+
+/// @brief Bytes per default huge page, 2 MiB if unknown
+std::size_t huge_page_size();
+
+/// @brief Plain new[] memory, released by a default constructed deleter as well
+/// @return Empty block on failure
+block alloc_heap(std::size_t size);
+
+/// @param alignment Power of two, at least sizeof(void*)
+/// @return Empty block on failure
+block alloc_aligned(std::size_t size, std::size_t alignment = 64, unsigned options = 0);
+
+/// @brief Memory backed by huge pages, aligned to huge_page_size()
+///
+/// Uses reserved huge pages (MAP_HUGETLB) when there are any, otherwise asks for transparent
+/// huge pages on an aligned mapping (MADV_HUGEPAGE). Without either the memory is still
+/// aligned but may use normal pages.
+block alloc_huge(std::size_t size, unsigned options = 0);
+
+/// @brief Page aligned memory placed on NUMA node @p node (mbind)
+///
+/// Fails for nodes that do not exist. On machines without NUMA only node 0 succeeds.
+block alloc_on_node(std::size_t size, unsigned node, unsigned options = 0);
+
+/// @brief Destroys an object from make_aligned() and frees its memory
+template <typename T>
+class object_deleter {
+public:
+    object_deleter() = default;
+    explicit object_deleter(deleter d)
+        : m_free(d)
+    {}
+
+    void operator()(T* p) const
+    {
+        if (!p)
+            return;
+        p->~T();
+        m_free(p);
+    }
+
+private:
+    deleter m_free;
+};
+
+template <typename T>
+using aligned_ptr = std::unique_ptr<T, object_deleter<T>>;
+
+/// @brief new T(args...) honouring alignof(T)
+///
+/// Before C++17 operator new only guarantees alignof(std::max_align_t), so types with
+/// alignas(64) members would lose the cache line separation they ask for.
+/// @return Empty pointer on failure
+template <typename T, typename... Args>
+aligned_ptr<T> make_aligned(Args&&... args)
+{
+    auto b = alloc_aligned(sizeof(T), alignof(T) < sizeof(void*) ? sizeof(void*) : alignof(T));
+    if (!b)
+        return aligned_ptr<T>();
+    auto raw = b.release(); // frees the memory if the constructor throws
+    auto p   = new (raw.get()) T(std::forward<Args>(args)...);
+    auto d   = raw.get_deleter();
+    raw.release();
+    return aligned_ptr<T>(p, object_deleter<T>(d));
+}
+
+} // namespace memory
+} // namespace os
+
+#endif // OSAL_MEMORY_H
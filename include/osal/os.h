@@ -11,8 +11,13 @@
 #include <unistd.h>
 #endif
 
+#include "osal/arena.h"
+#include "osal/memory.h"
+#include <atomic>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <functional>
 #include <list>
 #include <memory>
 #include <string>
@@ -20,13 +25,58 @@
 namespace os {
 
 void sleep(uint32_t ms);
+
+/// @brief Sleep for at least @p ns nanoseconds, resuming after signal interruptions
+void sleep_for_ns(uint64_t ns);
+
+/// @brief Sleep until an absolute deadline, so periodic loops do not accumulate drift
+/// @param deadline_ns Point in time on the os::clock::monotonic_ns timeline
+/// @code
+///     auto next = os::clock::monotonic_ns();
+///     for (;;) {
+///         next += os::clock::ms_to_ns(1);
+///         os::sleep_until(next);
+///         // 1 kHz work
+///     }
+void sleep_until(uint64_t deadline_ns);
+
+/// @brief Sleep for @p ns, spinning through the last @p spin_ns to avoid timer slack and
+///        scheduler wake-up latency
+void precise_sleep(uint64_t ns, uint64_t spin_ns = 75000);
+void precise_sleep_until(uint64_t deadline_ns, uint64_t spin_ns = 75000);
+
+class thread_synchronizer;
+
+/// @brief Sleep that returns early once @p sync is stopped
+/// @return true if the full interval elapsed, false if @p sync was stopped
+/// @code
+///     while (os::sleep(5000, thread_sync))
+///         poll();
+bool sleep(uint32_t ms, thread_synchronizer& sync);
+bool sleep_for_ns(uint64_t ns, thread_synchronizer& sync);
+bool sleep_until(uint64_t deadline_ns, thread_synchronizer& sync);
+
+/// @brief Seconds since the epoch
+/// @note Second granularity and overflows in 2038, prefer os::clock::realtime_ns or
+///       os::clock::monotonic_ns from osal/clock.h
 int time_since_epoch();
 
 class recursive_mutex_lock;
 class temporary_unlock;
-class thread_synchronizer;
+
+#ifdef OSAL_LOCK_STATS
+namespace lock_stats {
+namespace detail {
+struct site;
+} // namespace detail
+} // namespace lock_stats
+#endif
 
 /// @brief Platform specific recursive mutex
+///
+/// When osal is built with OSAL_LOCK_STATS every acquire records contention, wait and hold
+/// times under the mutex name, see osal/lock_stats.h. With OSAL_TRACE contended acquires are
+/// recorded as os::trace spans named after the mutex. Otherwise the name is ignored.
 class recursive_mutex {
 #ifdef _WIN32
     using mutex_t = CRITICAL_SECTION;
@@ -39,6 +89,8 @@ class recursive_mutex {
 
 public:
     recursive_mutex();
+    /// @param name Static string identifying the mutex in lock statistics
+    explicit recursive_mutex(const char* name);
     recursive_mutex(const recursive_mutex& other) = delete;
     recursive_mutex(recursive_mutex&& other) noexcept = delete;
     recursive_mutex& operator=(const recursive_mutex& other) = delete;
@@ -49,6 +101,14 @@ private:
     void lock();
     void unlock();
     mutex_t m_mutex;
+#ifdef OSAL_LOCK_STATS
+    lock_stats::detail::site* m_site;
+    uint32_t m_depth{0};        // recursion depth, only touched by the owner
+    uint64_t m_acquired_at{0};  // cycles at the outermost lock
+#endif
+#ifdef OSAL_TRACE
+    const char* m_name;
+#endif
 };
 
 class recursive_mutex_lock {
@@ -78,6 +138,10 @@ public:
     friend temporary_unlock;
 
     thread_synchronizer() = default;
+    /// @param name Static string identifying the mutex in lock statistics
+    explicit thread_synchronizer(const char* name)
+        : m_mtx(name)
+    {}
     thread_synchronizer(const thread_synchronizer& other) = delete;
     thread_synchronizer(thread_synchronizer&& other) noexcept = delete;
     thread_synchronizer& operator=(const thread_synchronizer& other) = delete;
@@ -87,10 +151,23 @@ public:
     recursive_mutex_lock lock();
     void resume();
     void stop(); /// @brief Notify anyone using this to stop processing.
+    bool stopped() const { return m_stop.load(); }
+
+    /// @brief Block until stop() is called or @p deadline_ns passes on os::clock::monotonic_ns
+    /// @return true if stopped
+    bool wait_for_stop_until(uint64_t deadline_ns);
+
+    /// @brief Register a callback that stop() invokes while holding the lock
+    /// @return Id to pass to remove_stop_callback
+    std::size_t add_stop_callback(std::function<void()> callback);
+    void remove_stop_callback(std::size_t id);
 
 private:
     os::recursive_mutex m_mtx;
-    bool m_stop{false};
+    std::atomic<bool> m_stop{false};
+    std::atomic<uint32_t> m_stop_epoch{0}; // futex word bumped by stop()
+    std::size_t m_next_callback_id{0};
+    std::list<std::pair<std::size_t, std::function<void()>>> m_stop_callbacks;
 };
 
 /// @brief Unlocks the mutex until the end of the local scope
@@ -120,6 +197,7 @@ inline char separator()
 }
 
 std::string join(const std::string& dir, const std::string& other);
+string_ref join(string_ref dir, string_ref other, arena& a);
 
 FILE* open(const char* path, const char* mode);
 FILE* open(const std::string& path, const std::string& mode);
@@ -145,6 +223,19 @@ size_t size(const std::string& path);
 size_t dump(const char* path, const char* data, size_t size, const char* mode = "wb");
 size_t dump(const std::string& path, const char* data, size_t size, const char* mode = "wb");
 size_t dump(const std::string& path, const std::string& data, const char* mode = "wb");
+
+struct dump_options {
+    const char* mode{"wb"};
+    /// Reserve the blocks for the write before it starts, see os::file::preallocate
+    bool preallocate{false};
+    /// Bytes to reserve from where the write starts, for files that keep growing after this
+    /// dump; 0 reserves what is written. The file size is only what was written.
+    uint64_t reserve{0};
+};
+
+/// @brief dump() with preallocation, so large outputs land in few extents
+size_t dump(const char* path, const char* data, size_t size, const dump_options& options);
+size_t dump(const std::string& path, const char* data, size_t size, const dump_options& options);
 std::list<std::string> list_dir(const char* path);
 std::list<std::string> list_dir(const std::string& path);
 std::string get_stem(const char* path, size_t size);
@@ -152,14 +243,30 @@ std::string get_stem(const std::string& path);
 std::string get_filename(const char* path, size_t size);
 std::string get_filename(const std::string& path);
 
+// Arena overloads, results live in the arena until it is reset so a listing costs a few chunk
+// allocations instead of one or two per entry
+arena_vector<string_ref> list_dir(const char* path, arena& a);
+string_ref get_stem(string_ref path, arena& a);
+string_ref get_filename(string_ref path, arena& a);
+
 struct ReadData {
     std::size_t num_bytes;
     std::unique_ptr<const char[]> data;
 };
 
+/// @brief ReadData whose memory came from an os::memory allocator
+struct BlockReadData {
+    std::size_t num_bytes;
+    std::unique_ptr<const char[], memory::deleter> data;
+};
+
 // @todo make this into a similar interface to context managers like thread_synchronizer
 ReadData read(const std::string& path);
 
+/// @brief read() into memory from @p allocate, e.g. os::memory::alloc_huge for large files
+/// @param allocate Called once with the file size plus one for the terminating null
+BlockReadData read(const std::string& path, const std::function<memory::block(std::size_t)>& allocate);
+
 } // namespace file
 } // namespace os
 
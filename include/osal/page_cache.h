@@ -0,0 +1,76 @@
+// page_cache.h
+//
+
+#ifndef OSAL_PAGE_CACHE_H
+#define OSAL_PAGE_CACHE_H
+
+#include "osal/extents.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+namespace os {
+namespace file {
+
+/// @brief How a file or mapping is about to be used
+enum class access {
+    normal,     ///< Forget earlier hints
+    sequential, ///< Read front to back, the kernel reads ahead further
+    random,     ///< No useful order, the kernel stops reading ahead
+    willneed,   ///< Start reading the range into the page cache now
+    dontneed,   ///< Drop the cached pages of the range; dirty pages are written back first
+    noreuse,    ///< Read once, do not keep the pages warm
+};
+
+/// @brief Tell the kernel how the @p range of @p path will be read
+///
+/// Wraps posix_fadvise. access::willneed uses readahead(), which queues the reads before it
+/// returns, so the data is on its way even if the advice alone would be ignored. A range of size
+/// 0 runs to the end of the file. Hints are best effort and never change what reads return.
+/// @return false if the file cannot be opened or the hint is not supported here
+/// @code
+///     os::file::advise(next_input, os::file::access::willneed); // prefetch while this one runs
+///     process(current_input);
+///     os::file::evict(current_input); // keep the cache for the online service
+bool advise(const std::string& path, access hint, extent range = extent{0, 0});
+/// @brief advise() on an open file; access::dontneed flushes its stdio buffer first
+bool advise(FILE* fd, access hint, extent range = extent{0, 0});
+
+/// @brief Tell the kernel how [@p addr, @p addr + @p len) of a mapping will be used
+///
+/// Wraps madvise; the range is widened to whole pages. access::dontneed on private or
+/// anonymous memory discards its contents, the next access sees the file again or zeros.
+/// access::noreuse is not available for memory and returns false.
+bool advise(const void* addr, std::size_t len, access hint);
+
+/// @brief Drop the cached pages of @p path
+///
+/// Dirty pages are written back first, since the kernel only drops clean ones. Pages mapped or
+/// locked by any process stay.
+/// @return false if the file cannot be opened or eviction is not supported here
+bool evict(const std::string& path);
+
+struct residency_report {
+    uint64_t resident_pages; ///< Pages of the file in the page cache
+    uint64_t total_pages;    ///< Pages the file spans
+    std::size_t page_size;
+
+    /// @brief Resident share of the file, 1 for an empty one
+    double ratio() const
+    {
+        return total_pages ? static_cast<double>(resident_pages) / static_cast<double>(total_pages) : 1.0;
+    }
+};
+
+/// @brief How much of @p path is in the page cache
+///
+/// Maps the file without reading it and asks mincore, in windows of at most 1 GiB so huge files
+/// need little address space and a small vector. total_pages is 0 for an empty file, one that
+/// cannot be mapped, or where mincore is not available.
+residency_report residency(const std::string& path);
+
+} // namespace file
+} // namespace os
+
+#endif // OSAL_PAGE_CACHE_H
@@ -0,0 +1,30 @@
+// park.h
+//
+
+#ifndef OSAL_PARK_H
+#define OSAL_PARK_H
+
+#include <atomic>
+#include <cstdint>
+
+namespace os {
+namespace detail {
+
+/// @brief Block the calling thread while @p word still holds @p expected.
+///
+/// Uses a futex on Linux and a striped condition variable table elsewhere. Wake-ups may be
+/// spurious, callers re-check their condition in a loop.
+/// @param timeout_ns Relative timeout in nanoseconds, negative waits forever.
+/// @return false if the timeout expired
+bool park(const std::atomic<uint32_t>& word, uint32_t expected, int64_t timeout_ns = -1);
+
+/// @brief Wake one thread parked on @p word
+void unpark_one(const std::atomic<uint32_t>& word);
+
+/// @brief Wake every thread parked on @p word
+void unpark_all(const std::atomic<uint32_t>& word);
+
+} // namespace detail
+} // namespace os
+
+#endif // OSAL_PARK_H
@@ -0,0 +1,373 @@
+// queue.h
+//
+
+#ifndef OSAL_QUEUE_H
+#define OSAL_QUEUE_H
+
+#include "osal/clock.h"
+#include "osal/park.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace os {
+namespace detail {
+
+constexpr std::size_t cache_line_size = 64;
+
+inline std::size_t round_up_pow2(std::size_t v)
+{
+    std::size_t p = 1;
+    while (p < v)
+        p <<= 1;
+    return p;
+}
+
+/// @brief Lets consumers of a lock-free queue park while it is empty
+///
+/// Producers only pay for a fence and a load when the queue was created blocking, and only
+/// touch the futex when somebody is actually waiting.
+class queue_waiters {
+public:
+    explicit queue_waiters(bool enabled)
+        : m_enabled(enabled)
+    {}
+
+    bool enabled() const { return m_enabled; }
+
+    void notify()
+    {
+        if (!m_enabled)
+            return;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_relaxed) != 0)
+        {
+            m_signal.fetch_add(1, std::memory_order_release);
+            unpark_all(m_signal);
+        }
+    }
+
+    /// @brief Wait until @p try_pop succeeds or @p timeout_ns expires
+    ///
+    /// The timeout is one deadline for the whole call, wake-ups that lose the element to another
+    /// consumer only park for what is left of it.
+    template <typename TryPop>
+    bool wait(TryPop try_pop, int64_t timeout_ns)
+    {
+        const bool forever      = timeout_ns < 0;
+        const uint64_t deadline = forever ? 0 : clock::monotonic_ns() + static_cast<uint64_t>(timeout_ns);
+        for (;;)
+        {
+            if (try_pop())
+                return true;
+            int64_t left = -1;
+            if (!forever)
+            {
+                auto now = clock::monotonic_ns();
+                if (now >= deadline)
+                    return false;
+                left = static_cast<int64_t>(deadline - now);
+            }
+            if (!m_enabled)
+            {
+                // Non-blocking queues have no producer-side wake, fall back to yielding
+                std::this_thread::yield();
+                continue;
+            }
+
+            m_waiters.fetch_add(1, std::memory_order_seq_cst);
+            auto signal = m_signal.load(std::memory_order_acquire);
+            if (try_pop())
+            {
+                m_waiters.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+            auto woken = park(m_signal, signal, left);
+            m_waiters.fetch_sub(1, std::memory_order_relaxed);
+            if (!woken)
+                return try_pop();
+        }
+    }
+
+private:
+    bool m_enabled;
+    std::atomic<uint32_t> m_waiters{0};
+    std::atomic<uint32_t> m_signal{0};
+};
+
+} // namespace detail
+
+/// @brief Bounded lock-free single-producer single-consumer ring queue
+///
+/// Capacity is rounded up to a power of two. Head and tail live on their own cache lines and
+/// each side caches the other side's index, so the shared lines are only touched when the
+/// cached view says the queue is full or empty.
+template <typename T>
+class spsc_queue {
+public:
+    /// @param blocking Enables pop_wait() parking, costs producers a fence per push
+    explicit spsc_queue(std::size_t capacity, bool blocking = false)
+        : m_mask(detail::round_up_pow2(capacity < 2 ? 2 : capacity) - 1)
+        , m_slots(new storage[m_mask + 1])
+        , m_waiters(blocking)
+    {}
+    spsc_queue(const spsc_queue& other) = delete;
+    spsc_queue(spsc_queue&& other) noexcept = delete;
+    spsc_queue& operator=(const spsc_queue& other) = delete;
+    spsc_queue& operator=(spsc_queue&& other) noexcept = delete;
+    ~spsc_queue()
+    {
+        for (auto i = m_head.load(); i != m_tail.load(); i++)
+            reinterpret_cast<T*>(&m_slots[i & m_mask])->~T();
+    }
+
+    template <typename U>
+    bool try_push(U&& item)
+    {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        if (tail - m_head_cache > m_mask)
+        {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            if (tail - m_head_cache > m_mask)
+                return false;
+        }
+        new (&m_slots[tail & m_mask]) T(std::forward<U>(item));
+        m_tail.store(tail + 1, std::memory_order_release);
+        m_waiters.notify();
+        return true;
+    }
+
+    /// @return Number of items pushed, may be less than @p count when the queue fills up
+    std::size_t try_push(const T* items, std::size_t count)
+    {
+        auto tail = m_tail.load(std::memory_order_relaxed);
+        auto free = capacity() - (tail - m_head_cache);
+        if (free < count)
+        {
+            m_head_cache = m_head.load(std::memory_order_acquire);
+            free = capacity() - (tail - m_head_cache);
+        }
+        auto n = count < free ? count : free;
+        for (std::size_t i = 0; i < n; i++)
+            new (&m_slots[(tail + i) & m_mask]) T(items[i]);
+        if (n != 0)
+        {
+            m_tail.store(tail + n, std::memory_order_release);
+            m_waiters.notify();
+        }
+        return n;
+    }
+
+    bool try_pop(T& out)
+    {
+        auto head = m_head.load(std::memory_order_relaxed);
+        if (head == m_tail_cache)
+        {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+            if (head == m_tail_cache)
+                return false;
+        }
+        auto slot = reinterpret_cast<T*>(&m_slots[head & m_mask]);
+        out = std::move(*slot);
+        slot->~T();
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @return Number of items popped into @p out, at most @p count
+    std::size_t try_pop(T* out, std::size_t count)
+    {
+        auto head = m_head.load(std::memory_order_relaxed);
+        auto avail = m_tail_cache - head;
+        if (avail < count)
+        {
+            m_tail_cache = m_tail.load(std::memory_order_acquire);
+            avail = m_tail_cache - head;
+        }
+        auto n = count < avail ? count : avail;
+        for (std::size_t i = 0; i < n; i++)
+        {
+            auto slot = reinterpret_cast<T*>(&m_slots[(head + i) & m_mask]);
+            out[i] = std::move(*slot);
+            slot->~T();
+        }
+        if (n != 0)
+            m_head.store(head + n, std::memory_order_release);
+        return n;
+    }
+
+    /// @brief Pop, parking while the queue is empty
+    /// @param timeout_ns Relative timeout, negative waits forever
+    /// @return false on timeout
+    bool pop_wait(T& out, int64_t timeout_ns = -1)
+    {
+        return m_waiters.wait([this, &out]() { return try_pop(out); }, timeout_ns);
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+    std::size_t size() const { return m_tail.load() - m_head.load(); }
+    bool empty() const { return size() == 0; }
+
+private:
+    using storage = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+    const std::size_t m_mask;
+    std::unique_ptr<storage[]> m_slots;
+    detail::queue_waiters m_waiters;
+
+    alignas(detail::cache_line_size) std::atomic<std::size_t> m_head{0};
+    std::size_t m_tail_cache{0}; // consumer's view of m_tail
+
+    alignas(detail::cache_line_size) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_head_cache{0}; // producer's view of m_head
+};
+
+/// @brief Bounded lock-free multi-producer multi-consumer ring queue
+///
+/// Vyukov's bounded queue: every cell carries a sequence number telling producers and consumers
+/// whose turn it is, so each operation is a single CAS on the shared position. Batch operations
+/// claim a run of ready cells with one CAS.
+template <typename T>
+class mpmc_queue {
+public:
+    /// @param blocking Enables pop_wait() parking, costs producers a fence per push
+    explicit mpmc_queue(std::size_t capacity, bool blocking = false)
+        : m_mask(detail::round_up_pow2(capacity < 2 ? 2 : capacity) - 1)
+        , m_cells(new cell[m_mask + 1])
+        , m_waiters(blocking)
+    {
+        for (std::size_t i = 0; i <= m_mask; i++)
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+    mpmc_queue(const mpmc_queue& other) = delete;
+    mpmc_queue(mpmc_queue&& other) noexcept = delete;
+    mpmc_queue& operator=(const mpmc_queue& other) = delete;
+    mpmc_queue& operator=(mpmc_queue&& other) noexcept = delete;
+    ~mpmc_queue()
+    {
+        for (auto i = m_dequeue.load(); i != m_enqueue.load(); i++)
+            reinterpret_cast<T*>(&m_cells[i & m_mask].data)->~T();
+    }
+
+    template <typename U>
+    bool try_push(U&& item)
+    {
+        std::size_t pos;
+        if (claim(m_enqueue, 0, 1, pos) == 0)
+            return false;
+        auto& c = m_cells[pos & m_mask];
+        new (&c.data) T(std::forward<U>(item));
+        c.seq.store(pos + 1, std::memory_order_release);
+        m_waiters.notify();
+        return true;
+    }
+
+    /// @return Number of items pushed, may be less than @p count when the queue fills up
+    std::size_t try_push(const T* items, std::size_t count)
+    {
+        std::size_t pos;
+        auto n = claim(m_enqueue, 0, count, pos);
+        for (std::size_t i = 0; i < n; i++)
+        {
+            auto& c = m_cells[(pos + i) & m_mask];
+            new (&c.data) T(items[i]);
+            c.seq.store(pos + i + 1, std::memory_order_release);
+        }
+        if (n != 0)
+            m_waiters.notify();
+        return n;
+    }
+
+    bool try_pop(T& out)
+    {
+        std::size_t pos;
+        if (claim(m_dequeue, 1, 1, pos) == 0)
+            return false;
+        release(pos, out);
+        return true;
+    }
+
+    /// @return Number of items popped into @p out, at most @p count
+    std::size_t try_pop(T* out, std::size_t count)
+    {
+        std::size_t pos;
+        auto n = claim(m_dequeue, 1, count, pos);
+        for (std::size_t i = 0; i < n; i++)
+            release(pos + i, out[i]);
+        return n;
+    }
+
+    /// @brief Pop, parking while the queue is empty
+    /// @param timeout_ns Relative timeout, negative waits forever
+    /// @return false on timeout
+    bool pop_wait(T& out, int64_t timeout_ns = -1)
+    {
+        return m_waiters.wait([this, &out]() { return try_pop(out); }, timeout_ns);
+    }
+
+    std::size_t capacity() const { return m_mask + 1; }
+
+private:
+    using storage = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+    struct cell {
+        std::atomic<std::size_t> seq;
+        storage data;
+    };
+
+    /// Claim up to @p count consecutive cells whose sequence equals position + @p lag, i.e. empty
+    /// cells for producers (lag 0) or full cells for consumers (lag 1).
+    std::size_t claim(std::atomic<std::size_t>& position, std::size_t lag, std::size_t count, std::size_t& pos)
+    {
+        pos = position.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            std::size_t ready = 0;
+            while (ready < count && ready <= m_mask)
+            {
+                auto seq = m_cells[(pos + ready) & m_mask].seq.load(std::memory_order_acquire);
+                if (seq != pos + ready + lag)
+                    break;
+                ready++;
+            }
+
+            if (ready == 0)
+            {
+                auto seq = m_cells[pos & m_mask].seq.load(std::memory_order_acquire);
+                auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + lag);
+                if (diff < 0)
+                    return 0; // full for producers, empty for consumers
+                pos = position.load(std::memory_order_relaxed);
+                continue;
+            }
+
+            if (position.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed))
+                return ready;
+        }
+    }
+
+    void release(std::size_t pos, T& out)
+    {
+        auto& c = m_cells[pos & m_mask];
+        auto item = reinterpret_cast<T*>(&c.data);
+        out = std::move(*item);
+        item->~T();
+        c.seq.store(pos + m_mask + 1, std::memory_order_release);
+    }
+
+    const std::size_t m_mask;
+    std::unique_ptr<cell[]> m_cells;
+    detail::queue_waiters m_waiters;
+
+    alignas(detail::cache_line_size) std::atomic<std::size_t> m_enqueue{0};
+    alignas(detail::cache_line_size) std::atomic<std::size_t> m_dequeue{0};
+};
+
+} // namespace os
+
+#endif // OSAL_QUEUE_H
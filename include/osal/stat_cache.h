@@ -0,0 +1,101 @@
+// stat_cache.h
+//
+
+#ifndef OSAL_STAT_CACHE_H
+#define OSAL_STAT_CACHE_H
+
+#include "osal/clock.h"
+#include "osal/os.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace os {
+namespace file {
+
+class watcher;
+
+/// @brief Answers is_reg_file, is_dir and size from memory
+///
+/// One stat per path fills an entry that serves all three questions until it is older than the
+/// TTL. Entries are spread over independently locked shards, so threads looking up different
+/// paths rarely contend. watch() additionally drops entries as soon as inotify reports a
+/// change, which allows a long TTL without serving stale answers for long.
+///
+/// Paths are cached as spelled, "./a" and "a" are different entries.
+/// @code
+///     static os::file::stat_cache cache(os::clock::s_to_ns(10));
+///     cache.watch("/srv/assets");
+///     if (cache.is_reg_file(path))
+///         serve(path, cache.size(path));
+class stat_cache {
+public:
+    /// @param ttl_ns Entries older than this are looked up again, 0 keeps them until invalidated
+    /// @param shards Number of independently locked maps, rounded up to a power of two
+    explicit stat_cache(uint64_t ttl_ns = clock::s_to_ns(1), std::size_t shards = 64);
+    stat_cache(const stat_cache& other) = delete;
+    stat_cache(stat_cache&& other) noexcept = delete;
+    stat_cache& operator=(const stat_cache& other) = delete;
+    stat_cache& operator=(stat_cache&& other) noexcept = delete;
+    ~stat_cache();
+
+    bool is_reg_file(const std::string& path);
+    bool is_dir(const std::string& path);
+    size_t size(const std::string& path);
+
+    /// @brief Drop cached entries as soon as anything below @p dir changes
+    /// @return false if the watch could not be placed, the TTL still applies then
+    bool watch(const std::string& dir, bool recursive = true);
+
+    /// @brief Forget @p path, the next query stats it again
+    void invalidate(const std::string& path);
+
+    /// @brief Forget @p path and every path below it
+    void invalidate_below(const std::string& path);
+
+    /// @brief Forget everything
+    void clear();
+
+    uint64_t hits() const;
+    uint64_t misses() const;
+
+    /// @brief Cached paths, including ones that did not exist
+    std::size_t entries() const;
+
+private:
+    struct entry {
+        uint64_t stamp_ns; ///< When the path was looked up
+        size_t size;
+        bool exists;
+        bool is_reg;
+        bool is_dir;
+    };
+
+    struct shard {
+        shard()
+            : mtx("os::file::stat_cache")
+        {}
+
+        mutable os::recursive_mutex mtx;
+        std::unordered_map<std::string, entry> map;
+        uint64_t hits{0};
+        uint64_t misses{0};
+        uint64_t generation{0}; ///< Bumped by every invalidation
+    };
+
+    entry lookup(const std::string& path);
+    shard& shard_of(const std::string& path) const;
+
+    const uint64_t m_ttl;
+    const std::size_t m_mask;
+    std::unique_ptr<shard[]> m_shards;
+
+    os::recursive_mutex m_watch_mtx{"os::file::stat_cache::watch"};
+    std::unique_ptr<watcher> m_watcher;
+};
+
+} // namespace file
+} // namespace os
+
+#endif // OSAL_STAT_CACHE_H
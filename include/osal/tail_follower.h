@@ -0,0 +1,109 @@
+// tail_follower.h
+//
+
+#ifndef OSAL_TAIL_FOLLOWER_H
+#define OSAL_TAIL_FOLLOWER_H
+
+#include "osal/arena.h"
+#include "osal/clock.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace os {
+namespace file {
+
+/// @brief Reads records appended to a growing file, like tail -F
+///
+/// The file stays open and every read continues at the previous offset, so following a log
+/// costs only the new bytes. A file that shrinks is read again from the start, after handing out
+/// an unfinished last record as it is. When the path is replaced (rotation by rename or delete
+/// and create) the rest of the old file is read before switching to the new one. wait() blocks
+/// on inotify until the file changes.
+///
+/// Records are handed out without their delimiter and are only valid during the callback. A
+/// record longer than 1 MiB without a delimiter is handed out in 1 MiB pieces.
+/// @code
+///     os::file::tail_follower tail("/var/log/app.log", [](os::string_ref line) {
+///         parse(line);
+///     }, os::file::tail_follower::from_end);
+///     std::thread t([&tail]() { tail.follow(); });
+///     ...
+///     tail.stop();
+///     t.join();
+class tail_follower {
+public:
+    using callback = std::function<void(string_ref record)>;
+
+    enum start_at {
+        from_beginning,
+        from_end, ///< Skip what the file holds at construction, later files are read fully
+    };
+
+    /// @param path File to follow, it does not have to exist yet
+    /// @param delimiter Byte ending each record
+    tail_follower(const std::string& path, callback cb, start_at start = from_beginning, char delimiter = '\n');
+    tail_follower(const tail_follower& other) = delete;
+    tail_follower(tail_follower&& other) noexcept = delete;
+    tail_follower& operator=(const tail_follower& other) = delete;
+    tail_follower& operator=(tail_follower&& other) noexcept = delete;
+    ~tail_follower();
+
+    /// @brief Read what was appended since the last call and hand out the complete records
+    /// @return Number of records handed out
+    std::size_t poll();
+
+    /// @brief Block until the file may have changed
+    /// @param timeout_ns Relative timeout, negative waits forever
+    /// @return false on timeout or stop()
+    bool wait(int64_t timeout_ns = -1);
+
+    /// @brief poll() and wait() until stop()
+    void follow();
+
+    /// @brief Make follow() return and wake wait(), callable from any thread
+    void stop();
+
+    bool is_open() const { return m_fd >= 0; }
+
+    /// @brief Bytes consumed from the current file
+    uint64_t offset() const { return m_offset; }
+
+    /// @brief Times the path was found to be a different file
+    uint64_t rotations() const { return m_rotations; }
+
+    /// @brief Times the file was found shorter than the offset
+    uint64_t truncations() const { return m_truncations; }
+
+private:
+    bool open_file(bool at_end);
+    void close_file();
+    std::size_t drain();
+    std::size_t flush_partial();
+
+    const std::string m_path;
+    const callback m_cb;
+    const char m_delimiter;
+
+    int m_fd{-1};
+    uint64_t m_dev{0};
+    uint64_t m_ino{0};
+    uint64_t m_offset{0};
+    std::vector<char> m_buf;
+    std::size_t m_carry{0}; // bytes of an incomplete record at the front of m_buf
+
+    int m_notify{-1};
+    int m_file_wd{-1};
+    int m_wake_fd{-1};
+    std::atomic<bool> m_stopping{false};
+
+    uint64_t m_rotations{0};
+    uint64_t m_truncations{0};
+};
+
+} // namespace file
+} // namespace os
+
+#endif // OSAL_TAIL_FOLLOWER_H
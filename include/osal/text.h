@@ -0,0 +1,130 @@
+// text.h
+//
+
+#ifndef OSAL_TEXT_H
+#define OSAL_TEXT_H
+
+#include "osal/arena.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace os {
+namespace text {
+
+/// @brief First @p c in [@p begin, @p end), @p end if there is none
+///
+/// Scans 32 or 16 bytes per step with AVX2 or SSE2, picked at runtime for the host CPU.
+const char* find_byte(const char* begin, const char* end, char c);
+
+/// @brief Longest record the splitters accept unless told otherwise
+constexpr std::size_t default_max_record = std::size_t(64) << 20;
+
+/// @brief Splits a stream of buffers into delimiter terminated records
+///
+/// Records are views into the fed buffer, the delimiter is not included. A record that starts
+/// in one buffer and ends in a later one is assembled in an internal buffer, so chunked input
+/// such as tail_follower or fixed size reads gives the same records as one big buffer. Views
+/// stay valid until the next call to next() or feed() and, for records inside a buffer, as
+/// long as that buffer.
+///
+/// Records longer than max_record are skipped up to their delimiter and counted in oversized(),
+/// so input without delimiters cannot make the splitter buffer without bound.
+/// @code
+///     auto data = os::file::read(path);
+///     os::text::line_splitter lines;
+///     lines.feed(os::string_ref(data.data.get(), data.num_bytes));
+///     os::string_ref line;
+///     while (lines.next(line) || lines.finish(line))
+///         parse(line);
+class line_splitter {
+public:
+    explicit line_splitter(char delimiter = '\n', std::size_t max_record = default_max_record)
+        : m_delimiter(delimiter)
+        , m_max(max_record)
+    {}
+
+    /// @brief Continue with @p chunk, the previous one must have been consumed by next()
+    void feed(string_ref chunk)
+    {
+        m_pos = chunk.begin();
+        m_end = chunk.end();
+    }
+
+    /// @brief Next complete record
+    /// @return false once the fed chunk is used up, the unterminated rest is kept for the next
+    bool next(string_ref& record);
+
+    /// @brief The unterminated rest at the end of the input
+    /// @return false if there is none
+    bool finish(string_ref& record);
+
+    /// @brief Bytes of an unterminated record kept from earlier chunks
+    std::size_t carried() const { return m_carry.size(); }
+
+    /// @brief Records skipped for being longer than max_record
+    uint64_t oversized() const { return m_oversized; }
+
+private:
+    std::string m_carry;
+    bool m_carry_done{false}; // m_carry was handed out and is cleared on the next call
+    bool m_skip{false};       // inside an oversized record, dropping input up to its delimiter
+    uint64_t m_oversized{0};
+    const char* m_pos{nullptr};
+    const char* m_end{nullptr};
+    const char m_delimiter;
+    const std::size_t m_max;
+};
+
+/// @brief Splits a stream of buffers into length prefixed records
+///
+/// Each record starts with an unsigned length of 1, 2, 4 or 8 bytes, not counting the prefix.
+/// Records split across chunks are assembled like in line_splitter. A length above max_record
+/// means a corrupt or hostile stream, which has no way to find the next record: the splitter
+/// stops there and overflowed() turns true.
+class record_splitter {
+public:
+    /// @param prefix_bytes 1, 2, 4 or 8
+    explicit record_splitter(std::size_t prefix_bytes = 4, bool big_endian = false,
+                             std::size_t max_record = default_max_record)
+        : m_prefix(prefix_bytes)
+        , m_big_endian(big_endian)
+        , m_max(std::min(max_record, SIZE_MAX - prefix_bytes))
+    {}
+
+    void feed(string_ref chunk)
+    {
+        m_pos = chunk.begin();
+        m_end = chunk.end();
+    }
+
+    /// @return false once the fed chunk is used up, or after an overflow
+    bool next(string_ref& record);
+
+    /// @brief true if the input ended inside a record
+    bool truncated() const { return !m_carry.empty(); }
+
+    std::size_t carried() const { return m_carry.size(); }
+
+    /// @brief true once a record announced more than max_record bytes
+    bool overflowed() const { return m_overflow; }
+
+private:
+    uint64_t length(const char* p) const;
+    bool overflow();
+
+    std::string m_carry;
+    bool m_carry_done{false};
+    bool m_overflow{false};
+    const char* m_pos{nullptr};
+    const char* m_end{nullptr};
+    const std::size_t m_prefix;
+    const bool m_big_endian;
+    const std::size_t m_max; // at most SIZE_MAX - m_prefix, so prefix plus body never wraps
+};
+
+} // namespace text
+} // namespace os
+
+#endif // OSAL_TEXT_H
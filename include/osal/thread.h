@@ -0,0 +1,60 @@
+// thread.h
+//
+
+#ifndef OSAL_THREAD_H
+#define OSAL_THREAD_H
+
+#include <string>
+#include <vector>
+
+namespace os {
+
+/// @brief CPUs this process may run on (its affinity mask), at least 1
+unsigned cpu_count();
+
+/// @brief Ids of the CPUs that are online, ascending
+std::vector<unsigned> online_cpus();
+
+/// @brief Properties of the calling thread
+///
+/// Functions that change something return false when the platform or the caller's privileges
+/// do not allow it.
+namespace this_thread {
+
+/// @brief Restrict the calling thread to @p cpus
+bool set_affinity(const std::vector<unsigned>& cpus);
+
+/// @brief CPUs the calling thread may run on, ascending
+std::vector<unsigned> affinity();
+
+/// @brief Restrict the calling thread to a single CPU
+bool pin(unsigned cpu);
+
+/// @brief Name shown by debuggers, top and trace viewers
+/// @param name Truncated to 15 characters on Linux
+bool set_name(const char* name);
+std::string name();
+
+enum class sched_policy {
+    other,       ///< Default time sharing
+    batch,       ///< Time sharing, treated as CPU bound
+    idle,        ///< Runs only when nothing else wants the CPU
+    fifo,        ///< Real time, runs until it blocks or yields, usually needs privileges
+    round_robin, ///< Real time with a time slice, usually needs privileges
+};
+
+/// @param priority Real time priority for fifo and round_robin, ignored otherwise
+bool set_scheduling(sched_policy policy, int priority = 0);
+sched_policy scheduling_policy();
+int scheduling_priority();
+
+/// @brief Time sharing niceness, from -20 (favoured) to 19
+///
+/// Per thread on Linux and Windows, per process elsewhere. Lowering it usually needs privileges.
+bool set_nice(int nice);
+int nice();
+
+} // namespace this_thread
+} // namespace os
+
+#endif // OSAL_THREAD_H
@@ -0,0 +1,162 @@
+// thread_pool.h
+//
+
+#ifndef OSAL_THREAD_POOL_H
+#define OSAL_THREAD_POOL_H
+
+#include "osal/os.h"
+#include "osal/park.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace os {
+
+/// @brief Work-stealing thread pool
+///
+/// Every worker owns a Chase-Lev deque. Tasks submitted from a worker go to its own deque, tasks
+/// submitted from other threads go through a shared injection queue. Idle workers steal from
+/// their peers and park when there is nothing left to run.
+///
+/// @code
+///     os::thread_pool pool;
+///     auto f = pool.submit([](int x) { return x * 2; }, 21);
+///     f.get(); // 42
+class thread_pool {
+public:
+    using task = std::function<void()>;
+
+    /// @param num_threads Number of workers, 0 uses the hardware concurrency
+    explicit thread_pool(std::size_t num_threads = 0);
+
+    /// @brief Pool that shuts down gracefully once @p sync is stopped
+    ///
+    /// Queued work still runs, new submissions are rejected. Resuming @p sync does not restart
+    /// the pool.
+    explicit thread_pool(thread_synchronizer& sync, std::size_t num_threads = 0);
+
+    thread_pool(const thread_pool& other) = delete;
+    thread_pool(thread_pool&& other) noexcept = delete;
+    thread_pool& operator=(const thread_pool& other) = delete;
+    thread_pool& operator=(thread_pool&& other) noexcept = delete;
+    ~thread_pool();
+
+    /// @brief Queue @p t for execution
+    /// @return false if the pool is shutting down
+    bool post(task t);
+
+    /// @brief Queue a call to @p f with @p args
+    /// @return Future for the result, or a future without shared state (valid() == false) if
+    ///         the pool is shutting down
+    template <typename F, typename... Args>
+    auto submit(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>;
+
+    /// @brief Call @p body(i) for every i in [begin, end) and wait for completion
+    ///
+    /// The range is split into chunks of @p grain indices (0 picks a grain giving a few chunks per
+    /// worker). The calling thread runs chunks as well, so this may be called from inside a task.
+    /// @p body must not throw.
+    template <typename F>
+    void parallel_for(std::size_t begin, std::size_t end, F&& body, std::size_t grain = 0);
+
+    /// @brief Stop accepting work, run everything already queued and join the workers
+    void shutdown();
+
+    bool stopping() const { return m_stopping.load(); }
+    std::size_t size() const { return m_workers.size(); }
+
+private:
+    struct worker;
+
+    void start(std::size_t num_threads);
+    void begin_stop();
+    void run(std::size_t index);
+    bool run_one(std::size_t index);
+    task* find_task(std::size_t index);
+    void notify();
+
+    std::vector<memory::aligned_ptr<worker>> m_workers;
+    std::vector<std::thread> m_threads;
+
+    os::recursive_mutex m_inject_mtx{"os::thread_pool"};
+    std::deque<task*> m_inject;
+    std::atomic<std::size_t> m_inject_size{0};
+
+    std::atomic<bool> m_stopping{false};
+    std::atomic<uint32_t> m_epoch{0};
+    std::atomic<uint32_t> m_idle{0};
+
+    thread_synchronizer* m_sync{nullptr};
+    std::size_t m_sync_callback{0};
+};
+
+template <typename F, typename... Args>
+auto thread_pool::submit(F&& f, Args&&... args) -> std::future<typename std::result_of<F(Args...)>::type>
+{
+    using result_t = typename std::result_of<F(Args...)>::type;
+
+    auto job = std::make_shared<std::packaged_task<result_t()>>(
+        std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+    auto future = job->get_future();
+    if (!post([job]() { (*job)(); }))
+        return std::future<result_t>();
+    return future;
+}
+
+template <typename F>
+void thread_pool::parallel_for(std::size_t begin, std::size_t end, F&& body, std::size_t grain)
+{
+    if (end <= begin)
+        return;
+
+    auto count = end - begin;
+    if (grain == 0)
+        grain = std::max<std::size_t>(1, count / (4 * std::max<std::size_t>(1, size())));
+    auto chunks = (count + grain - 1) / grain;
+
+    struct state {
+        std::atomic<std::size_t> next{0};
+        std::atomic<uint64_t> done{0};
+        std::atomic<uint32_t> finished{0}; // parked on, futex words are 32 bits
+    };
+    // Helpers may be scheduled after this call returned, so they share ownership of the state
+    auto s = std::make_shared<state>();
+    auto fn = std::make_shared<typename std::decay<F>::type>(std::forward<F>(body));
+
+    auto work = [s, fn, begin, end, grain, chunks]() {
+        for (auto c = s->next.fetch_add(1); c < chunks; c = s->next.fetch_add(1))
+        {
+            auto first = begin + c * grain;
+            auto last  = std::min(end, first + grain);
+            for (auto i = first; i < last; i++)
+                (*fn)(i);
+            if (s->done.fetch_add(1) + 1 == chunks)
+            {
+                s->finished.store(1);
+                detail::unpark_all(s->finished);
+            }
+        }
+    };
+
+    auto helpers = std::min(chunks - 1, size());
+    for (std::size_t i = 0; i < helpers; i++)
+    {
+        if (!post(work))
+            break;
+    }
+    work();
+
+    while (s->finished.load() == 0)
+        detail::park(s->finished, 0);
+}
+
+} // namespace os
+
+#endif // OSAL_THREAD_POOL_H
@@ -0,0 +1,110 @@
+// timer_service.h
+//
+
+#ifndef OSAL_TIMER_SERVICE_H
+#define OSAL_TIMER_SERVICE_H
+
+#include "osal/clock.h"
+#include "osal/os.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+namespace os {
+
+class thread_pool;
+
+/// @brief One-shot and periodic timers driven by a single thread
+///
+/// Timers live in a hierarchical timing wheel (256 slots of one tick, then three levels of 64
+/// slots), so schedule and cancel are O(1) regardless of how many timers are pending. The
+/// service thread sleeps on the monotonic clock until the next occupied slot.
+///
+/// @code
+///     os::timer_service timers;
+///     auto id = timers.schedule(os::clock::s_to_ns(30), [conn]() { conn->timeout(); });
+///     // reply arrived
+///     timers.cancel(id);
+class timer_service {
+public:
+    using callback = std::function<void()>;
+    using timer_id = uint64_t; ///< 0 is never a valid id
+
+    /// @param resolution_ns Length of a wheel tick, timers fire up to one tick late
+    explicit timer_service(uint64_t resolution_ns = clock::ms_to_ns(1));
+
+    /// @brief Run callbacks on @p pool instead of the service thread
+    explicit timer_service(thread_pool& pool, uint64_t resolution_ns = clock::ms_to_ns(1));
+
+    timer_service(const timer_service& other) = delete;
+    timer_service(timer_service&& other) noexcept = delete;
+    timer_service& operator=(const timer_service& other) = delete;
+    timer_service& operator=(timer_service&& other) noexcept = delete;
+    ~timer_service();
+
+    /// @brief Call @p cb once after @p delay_ns
+    timer_id schedule(uint64_t delay_ns, callback cb);
+
+    /// @brief Call @p cb once at @p deadline_ns on the os::clock::monotonic_ns timeline
+    timer_id schedule_at(uint64_t deadline_ns, callback cb);
+
+    /// @brief Call @p cb every @p period_ns, first after @p period_ns. Firings are spaced from
+    ///        the previous deadline, not from when the callback ran, so they do not drift.
+    timer_id schedule_periodic(uint64_t period_ns, callback cb);
+
+    /// @return false if @p id already fired (one-shot) or was cancelled
+    bool cancel(timer_id id);
+
+    /// @brief Number of pending timers
+    std::size_t size() const { return m_count.load(); }
+
+    /// @brief Stop the service thread, pending timers are dropped
+    void stop();
+
+private:
+    struct node {
+        uint64_t deadline; ///< ns on the monotonic clock
+        uint64_t period;   ///< 0 for one-shot timers
+        uint64_t tick;
+        std::shared_ptr<callback> cb;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t slot; ///< UINT32_MAX while not in the wheel
+        uint32_t generation;
+    };
+
+    timer_id add(uint64_t deadline_ns, uint64_t period_ns, callback cb);
+    void insert(uint32_t index);
+    void unlink(uint32_t index);
+    uint32_t allocate();
+    void release(uint32_t index);
+    void advance(std::vector<std::shared_ptr<callback>>& expired);
+    uint64_t next_wakeup_tick() const;
+    uint64_t current_tick() const;
+    uint64_t to_tick(uint64_t deadline_ns) const;
+    void dispatch(std::vector<std::shared_ptr<callback>>& expired);
+    void run();
+
+    const uint64_t m_resolution;
+    const uint64_t m_start;
+    thread_pool* m_pool{nullptr};
+
+    os::recursive_mutex m_mtx{"os::timer_service"};
+    std::vector<node> m_nodes;
+    uint32_t m_free{UINT32_MAX};
+    std::vector<uint32_t> m_slots; // list heads, all levels back to back
+    uint64_t m_tick{0};
+    uint64_t m_wake_tick{UINT64_MAX}; // tick the service thread sleeps until
+    std::atomic<std::size_t> m_count{0};
+
+    std::atomic<bool> m_stopping{false};
+    std::atomic<uint32_t> m_wake{0};
+    std::thread m_thread;
+};
+
+} // namespace os
+
+#endif // OSAL_TIMER_SERVICE_H
@@ -0,0 +1,69 @@
+// topology.h
+//
+
+#ifndef OSAL_TOPOLOGY_H
+#define OSAL_TOPOLOGY_H
+
+#include <cstddef>
+#include <vector>
+
+namespace os {
+namespace topology {
+
+enum class cache_type { data, instruction, unified };
+
+struct cache {
+    unsigned level;
+    cache_type type;
+    std::size_t size; ///< Bytes
+    unsigned line_size;
+    unsigned ways;
+    std::vector<unsigned> shared_cpus; ///< Online CPUs using this cache, ascending
+};
+
+struct cpu {
+    unsigned id;
+    unsigned core;    ///< Index into the machine's physical cores, SMT siblings share it
+    unsigned package; ///< Socket
+    unsigned node;    ///< NUMA node, 0 without NUMA
+};
+
+struct machine {
+    std::vector<cpu> cpus;     ///< Online CPUs, ascending by id
+    std::vector<cache> caches; ///< Every distinct cache, ascending by level
+    unsigned cores;
+    unsigned packages;
+    unsigned nodes;
+};
+
+/// @brief The machine layout, discovered on the first call and cached
+///
+/// Read from sysfs on Linux. Elsewhere, or when sysfs is not mounted, cache parameters come
+/// from cpuid and every CPU is taken to be its own core on one package and node.
+const machine& get();
+
+/// @brief CPUs sharing a physical core with @p cpu, including itself
+std::vector<unsigned> smt_siblings(unsigned cpu);
+
+/// @brief CPUs sharing the level @p level data or unified cache with @p cpu, including itself
+///
+/// Empty when @p cpu has no such cache. sharing_cache(n, 3) answers "cores sharing L3 with n".
+std::vector<unsigned> sharing_cache(unsigned cpu, unsigned level);
+
+/// @brief NUMA node of @p cpu, 0 for unknown CPUs
+unsigned node_of(unsigned cpu);
+
+/// @brief Online CPUs on NUMA node @p node
+std::vector<unsigned> cpus_of_node(unsigned node);
+
+/// @brief Size in bytes of the level @p level data or unified cache of the first online CPU, 0 if
+/// unknown
+std::size_t cache_size(unsigned level);
+
+/// @brief Coherency line size, 64 if unknown
+unsigned cache_line_size();
+
+} // namespace topology
+} // namespace os
+
+#endif // OSAL_TOPOLOGY_H
@@ -0,0 +1,76 @@
+// trace.h
+//
+
+#ifndef OSAL_TRACE_H
+#define OSAL_TRACE_H
+
+#include "osal/clock.h"
+#include <cstdint>
+#include <string>
+
+namespace os {
+namespace trace {
+
+/// @brief True when osal was built with OSAL_TRACE
+///
+/// Without it spans compile to nothing and the trace is always empty.
+bool enabled();
+
+/// @brief Buffered spans of all threads in Chrome trace event JSON
+///
+/// Load the result in chrome://tracing or ui.perfetto.dev. Timestamps are on
+/// os::clock::monotonic_ns. Each thread keeps its most recent spans in a fixed ring, older ones
+/// are overwritten.
+std::string chrome_json();
+
+/// @brief Write chrome_json() to @p path
+bool dump(const char* path);
+
+/// @brief Drop all buffered spans
+void reset();
+
+namespace detail {
+
+void record(const char* name, const char* category, uint64_t start_cycles, uint64_t end_cycles);
+
+} // namespace detail
+
+/// @brief Records the lifetime of the enclosing scope as a span
+/// @code
+///     os::trace::span s("handle_request");
+class span {
+public:
+    /// @param name, category Static strings, only the pointers are stored
+    explicit span(const char* name, const char* category = "app")
+#ifdef OSAL_TRACE
+        : m_name(name)
+        , m_category(category)
+        , m_start(clock::cycles())
+#endif
+    {
+        (void)name;
+        (void)category;
+    }
+    span(const span& other) = delete;
+    span(span&& other) noexcept = delete;
+    span& operator=(const span& other) = delete;
+    span& operator=(span&& other) noexcept = delete;
+    ~span()
+    {
+#ifdef OSAL_TRACE
+        detail::record(m_name, m_category, m_start, clock::cycles());
+#endif
+    }
+
+#ifdef OSAL_TRACE
+private:
+    const char* m_name;
+    const char* m_category;
+    uint64_t m_start;
+#endif
+};
+
+} // namespace trace
+} // namespace os
+
+#endif // OSAL_TRACE_H
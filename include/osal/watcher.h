@@ -0,0 +1,155 @@
+// watcher.h
+//
+
+#ifndef OSAL_WATCHER_H
+#define OSAL_WATCHER_H
+
+#include "osal/clock.h"
+#include "osal/memory.h"
+#include "osal/os.h"
+#include "osal/queue.h"
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace os {
+
+class thread_pool;
+
+namespace file {
+
+/// @brief What happened to a path, combined with | when several changes fall in one window
+enum change : unsigned {
+    created  = 1u << 0, ///< Created or moved in
+    modified = 1u << 1, ///< Content written
+    closed   = 1u << 2, ///< Closed after writing, the writer is done with the file
+    deleted  = 1u << 3, ///< Deleted or moved out
+    attrib   = 1u << 4, ///< Permissions, timestamps or ownership changed
+    rescan   = 1u << 5, ///< Events were lost, list the directory again to catch up
+};
+
+struct watch_event {
+    watch_event() = default;
+    watch_event(std::string p, unsigned c, bool d)
+        : path(std::move(p))
+        , changes(c)
+        , is_dir(d)
+    {}
+
+    std::string path;
+    unsigned changes{0}; ///< os::file::change flags
+    bool is_dir{false};
+};
+
+/// @brief Reports changes below watched directories from a single service thread
+///
+/// Built on inotify. Events for the same path that arrive within the coalescing window are
+/// merged into one watch_event, so a file written in many small chunks is reported once.
+/// Recursive watches follow directories created later; files that appear in a new directory
+/// before its watch is in place are reported as created. When the kernel queue overflows the
+/// watches are rebuilt and every root is reported with os::file::rescan.
+///
+/// Events go to a callback, or with the default constructor to an internal queue read by
+/// poll(). Not available outside Linux, add() returns false there.
+/// @code
+///     os::file::watcher w([](const os::file::watch_event& e) {
+///         if (e.changes & os::file::closed)
+///             ingest(e.path);
+///     });
+///     w.add("/var/spool/drop");
+class watcher {
+public:
+    using callback = std::function<void(const watch_event&)>;
+
+    /// @brief Queue events for poll()
+    /// @param coalesce_ns Window in which events for one path are merged
+    /// @param capacity Queued events, when the queue is full events are dropped and a rescan
+    ///        event is queued for every root once there is room again
+    explicit watcher(uint64_t coalesce_ns = clock::ms_to_ns(10), std::size_t capacity = 4096);
+
+    /// @brief Call @p cb on the service thread
+    explicit watcher(callback cb, uint64_t coalesce_ns = clock::ms_to_ns(10));
+
+    /// @brief Call @p cb on @p pool
+    watcher(thread_pool& pool, callback cb, uint64_t coalesce_ns = clock::ms_to_ns(10));
+
+    watcher(const watcher& other) = delete;
+    watcher(watcher&& other) noexcept = delete;
+    watcher& operator=(const watcher& other) = delete;
+    watcher& operator=(watcher&& other) noexcept = delete;
+    ~watcher();
+
+    /// @brief Watch the directory @p path, and with @p recursive every directory below it
+    /// @return false if @p path is not a directory or the watch limit is reached
+    bool add(const std::string& path, bool recursive = true);
+
+    /// @brief Stop watching @p path and, if it was added recursively, the directories below it
+    bool remove(const std::string& path);
+
+    /// @brief Next queued event, only for watchers constructed without a callback
+    /// @param timeout_ns Relative timeout, negative waits forever
+    /// @return false on timeout
+    bool poll(watch_event& out, int64_t timeout_ns = -1);
+
+    /// @brief Number of directories with a kernel watch
+    std::size_t watch_count() const;
+
+    /// @brief Stop the service thread, pending events are dropped
+    void stop();
+
+private:
+    struct dir {
+        std::string path;
+        bool recursive;
+    };
+
+    struct pending {
+        watch_event event;
+        uint64_t first_ns; ///< Coalescing window starts here
+    };
+
+    void start();
+    bool watch_tree(const std::string& path, bool recursive, bool report);
+    bool unwatch_below(const std::string& path);
+    void handle(int wd, uint32_t mask, const char* name);
+    void overflow();
+    void record(std::string path, unsigned changes, bool is_dir);
+    int64_t flush();
+    bool catch_up();
+    void dispatch(watch_event& e);
+    void run();
+
+    const uint64_t m_window;
+    std::shared_ptr<callback> m_cb;
+    thread_pool* m_pool{nullptr};
+    memory::aligned_ptr<mpmc_queue<watch_event>> m_queue; // cache line aligned head and tail
+    bool m_lost{false}; // queue overflowed, roots owe a rescan event
+
+    int m_fd{-1};
+    int m_wake_fd{-1};
+
+    mutable os::recursive_mutex m_mtx{"os::file::watcher"};
+    std::vector<dir> m_roots;
+    std::unordered_map<int, dir> m_dirs;            // watch descriptor to directory
+    std::unordered_map<std::string, int> m_watches; // directory to watch descriptor
+
+    // Service thread only
+    std::deque<pending> m_pending;
+    std::unordered_map<std::string, std::size_t> m_index; // path to position in m_pending
+    std::size_t m_flushed{0};                              // entries popped from m_pending
+
+    std::atomic<bool> m_stopping{false};
+    std::thread m_thread;
+};
+
+} // namespace file
+} // namespace os
+
+#endif // OSAL_WATCHER_H
@@ -0,0 +1,95 @@
+// arena.cpp
+//
+
+#include "osal/arena.h"
+#include <cstdint>
+#include <new>
+
+namespace os {
+
+arena::arena(std::size_t chunk_size)
+    : m_chunk_size(chunk_size ? chunk_size : 1)
+{}
+
+arena::~arena()
+{
+    for (auto c = m_first; c;)
+    {
+        auto next = c->next;
+        ::operator delete(c);
+        c = next;
+    }
+}
+
+arena& arena::local()
+{
+    static thread_local arena a;
+    return a;
+}
+
+static char* chunk_data(void* c, std::size_t header) { return static_cast<char*>(c) + header; }
+
+void* arena::allocate(std::size_t size, std::size_t alignment)
+{
+    const std::size_t header = (sizeof(chunk) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+    auto fit = [&](chunk* c) -> void* {
+        auto base    = reinterpret_cast<uintptr_t>(chunk_data(c, header));
+        auto aligned = (base + c->offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+        auto end     = aligned + size - base;
+        if (end > c->size)
+            return nullptr;
+        c->offset = end;
+        return reinterpret_cast<void*>(aligned);
+    };
+
+    // Chunks after the current one are either fresh or emptied by reset()
+    for (auto c = m_current; c; c = c->next)
+    {
+        if (auto p = fit(c))
+        {
+            m_current = c;
+            m_used += size;
+            return p;
+        }
+    }
+
+    auto bytes = size + alignment > m_chunk_size ? size + alignment : m_chunk_size;
+    auto c     = static_cast<chunk*>(::operator new(header + bytes));
+    c->next    = nullptr;
+    c->size    = bytes;
+    c->offset  = 0;
+    m_chunks++;
+    if (!m_first)
+    {
+        m_first = c;
+    }
+    else
+    {
+        auto last = m_current;
+        while (last->next)
+            last = last->next;
+        last->next = c;
+    }
+    m_current = c;
+    m_used += size;
+    return fit(c);
+}
+
+string_ref arena::copy(string_ref s)
+{
+    auto p = static_cast<char*>(allocate(s.size() + 1, 1));
+    if (s.size())
+        std::memcpy(p, s.data(), s.size());
+    p[s.size()] = '\0';
+    return string_ref(p, s.size());
+}
+
+void arena::reset()
+{
+    for (auto c = m_first; c; c = c->next)
+        c->offset = 0;
+    m_current = m_first;
+    m_used    = 0;
+}
+
+} // namespace os
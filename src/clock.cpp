@@ -0,0 +1,142 @@
+// clock.cpp
+//
+
+#include "osal/clock.h"
+#include <atomic>
+#include <mutex>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if OSAL_HAS_TSC && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+namespace os {
+namespace clock {
+
+#ifdef _WIN32
+static uint64_t qpc_to_ns(uint64_t ticks)
+{
+    static const uint64_t freq = []() {
+        LARGE_INTEGER f;
+        QueryPerformanceFrequency(&f);
+        return static_cast<uint64_t>(f.QuadPart);
+    }();
+    return (ticks / freq) * 1000000000 + (ticks % freq) * 1000000000 / freq;
+}
+
+uint64_t monotonic_ns()
+{
+    LARGE_INTEGER t;
+    QueryPerformanceCounter(&t);
+    return qpc_to_ns(static_cast<uint64_t>(t.QuadPart));
+}
+
+uint64_t monotonic_coarse_ns() { return GetTickCount64() * 1000000; }
+
+uint64_t realtime_ns()
+{
+    // FILETIME counts 100 ns intervals since 1601-01-01
+    FILETIME ft;
+    GetSystemTimePreciseAsFileTime(&ft);
+    auto t = (static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime;
+    return (t - 116444736000000000ull) * 100;
+}
+#else
+static uint64_t read_clock(clockid_t id)
+{
+    timespec ts{};
+    clock_gettime(id, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000 + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+uint64_t monotonic_ns() { return read_clock(CLOCK_MONOTONIC); }
+
+uint64_t monotonic_coarse_ns()
+{
+#ifdef CLOCK_MONOTONIC_COARSE
+    return read_clock(CLOCK_MONOTONIC_COARSE);
+#else
+    return read_clock(CLOCK_MONOTONIC);
+#endif
+}
+
+uint64_t realtime_ns() { return read_clock(CLOCK_REALTIME); }
+#endif // _WIN32
+
+bool tsc_invariant()
+{
+#if OSAL_HAS_TSC
+    // CPUID.80000007H:EDX[8]
+#ifdef _MSC_VER
+    int regs[4];
+    __cpuid(regs, 0x80000000);
+    if (static_cast<unsigned>(regs[0]) < 0x80000007)
+        return false;
+    __cpuid(regs, 0x80000007);
+    return (regs[3] & (1 << 8)) != 0;
+#else
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) == 0)
+        return false;
+    return (edx & (1u << 8)) != 0;
+#endif
+#else
+    return false;
+#endif
+}
+
+static std::atomic<double> s_cycles_per_ns{0.0};
+static std::once_flag s_calibrated;
+
+static void measure()
+{
+#if OSAL_HAS_TSC
+    // Spin for ~10 ms, bracketing each clock read with cycle reads and keeping the tightest
+    // bracket at both ends.
+    auto sample = [](uint64_t& ns, uint64_t& tsc) {
+        uint64_t best = UINT64_MAX;
+        for (int i = 0; i < 5; i++)
+        {
+            auto c0 = cycles();
+            auto t  = monotonic_ns();
+            auto c1 = cycles();
+            if (c1 - c0 < best)
+            {
+                best = c1 - c0;
+                ns   = t;
+                tsc  = c0 + (c1 - c0) / 2;
+            }
+        }
+    };
+
+    uint64_t ns0, tsc0, ns1, tsc1;
+    sample(ns0, tsc0);
+    do
+    {
+        sample(ns1, tsc1);
+    } while (ns1 - ns0 < 10000000);
+    s_cycles_per_ns = static_cast<double>(tsc1 - tsc0) / static_cast<double>(ns1 - ns0);
+#else
+    s_cycles_per_ns = 1.0;
+#endif
+}
+
+void calibrate() { std::call_once(s_calibrated, measure); }
+
+double cycles_per_ns()
+{
+    calibrate();
+    return s_cycles_per_ns.load(std::memory_order_relaxed);
+}
+
+uint64_t cycles_to_ns(uint64_t cycles) { return static_cast<uint64_t>(static_cast<double>(cycles) / cycles_per_ns()); }
+
+uint64_t ns_to_cycles(uint64_t ns) { return static_cast<uint64_t>(static_cast<double>(ns) * cycles_per_ns()); }
+
+} // namespace clock
+} // namespace os
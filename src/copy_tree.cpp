@@ -0,0 +1,426 @@
+// copy_tree.cpp
+//
+
+#include "osal/copy_tree.h"
+#include "osal/io_metrics.h"
+#include "osal/os.h"
+#include "fd_guard.h"
+#include "work_stack.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif
+
+#ifdef __APPLE__
+#define st_atim st_atimespec
+#define st_mtim st_mtimespec
+#endif
+
+namespace os {
+namespace file {
+
+#ifndef _WIN32
+namespace {
+
+using detail::fd_guard;
+
+/// A directory still to be copied, with its counterpart in the previous snapshot if any
+struct item {
+    std::string src;
+    std::string dst;
+    std::string prev;
+    std::size_t depth;
+};
+
+/// Permissions and times put on a directory after everything below it is written
+struct dir_fixup {
+    std::string path;
+    mode_t mode;
+    struct timespec times[2];
+    std::size_t depth;
+};
+
+/// What one worker did, merged when the walk is over
+struct local {
+    copy_report report;
+    std::vector<dir_fixup> dirs;
+};
+
+/// Copies [@p offset, @p offset + @p len) with pread and pwrite
+bool copy_buffered(int in, int out, off_t offset, uint64_t len, uint64_t& bytes)
+{
+    std::vector<char> buf(static_cast<std::size_t>(std::min<uint64_t>(len, 1 << 20)));
+    while (len > 0)
+    {
+        auto n = ::pread(in, buf.data(), static_cast<std::size_t>(std::min<uint64_t>(len, buf.size())), offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false; // an error, or the source shrank under us and the copy is short
+        for (ssize_t done = 0; done < n;)
+        {
+            auto w = ::pwrite(out, buf.data() + done, static_cast<std::size_t>(n - done), offset + done);
+            if (w < 0 && errno == EINTR)
+                continue;
+            if (w <= 0)
+                return false;
+            done += w;
+        }
+        offset += n;
+        len -= static_cast<uint64_t>(n);
+        bytes += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+/// Copies [@p offset, @p offset + @p len) inside the kernel, through user space where it cannot
+bool copy_range(int in, int out, off_t offset, uint64_t len, uint64_t& bytes)
+{
+#if defined(__linux__) && defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 27)
+    while (len > 0)
+    {
+        loff_t from = offset, to = offset;
+        auto n = copy_file_range(in, &from, out, &to, static_cast<std::size_t>(std::min<uint64_t>(len, 1u << 30)), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n < 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP))
+            return copy_buffered(in, out, offset, len, bytes);
+        if (n <= 0)
+            return false; // as in copy_buffered, a short copy is not a good one
+        offset += n;
+        len -= static_cast<uint64_t>(n);
+        bytes += static_cast<uint64_t>(n);
+    }
+    return true;
+#else
+    return copy_buffered(in, out, offset, len, bytes);
+#endif
+}
+
+/// Copies the data of @p in, skipping the holes of a sparse source
+bool copy_data(int in, int out, const struct stat& st, bool sparse, uint64_t& bytes)
+{
+    auto size = static_cast<uint64_t>(st.st_size);
+#ifdef SEEK_DATA
+    // Fewer blocks than bytes is the cheap hint that holes exist at all
+    if (sparse && static_cast<uint64_t>(st.st_blocks) * 512 < size)
+    {
+        off_t offset = 0;
+        while (static_cast<uint64_t>(offset) < size)
+        {
+            auto data = ::lseek(in, offset, SEEK_DATA);
+            if (data < 0 && errno == ENXIO)
+                break; // only a hole is left
+            if (data < 0)
+                return offset == 0 && copy_range(in, out, 0, size, bytes);
+            auto hole = ::lseek(in, data, SEEK_HOLE);
+            if (hole < 0)
+                hole = static_cast<off_t>(size);
+            hole = std::min(hole, static_cast<off_t>(size));
+            if (!copy_range(in, out, data, static_cast<uint64_t>(hole - data), bytes))
+                return false;
+            offset = hole;
+        }
+        return ::ftruncate(out, static_cast<off_t>(size)) == 0;
+    }
+#else
+    (void)sparse;
+#endif
+    return copy_range(in, out, 0, size, bytes);
+}
+
+/// Shares the extents of @p in with @p out
+bool clone(int in, int out)
+{
+#ifdef FICLONE
+    return ::ioctl(out, FICLONE, in) == 0;
+#else
+    (void)in;
+    (void)out;
+    return false;
+#endif
+}
+
+bool same_times(const struct timespec& a, const struct timespec& b)
+{
+    return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+}
+
+class copier {
+public:
+    /// @param root Status of the destination root, which is skipped if it turns up below the source
+    copier(const copy_options& options, const struct stat& root)
+        : m_options(options)
+        , m_root_dev(root.st_dev)
+        , m_root_ino(root.st_ino)
+    {}
+
+    /// Copies the entries of @p dir and collects its subdirectories in @p found
+    void scan(const item& dir, local& out, std::vector<item>& found)
+    {
+        int fd = ::open(dir.src.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        auto d = fd >= 0 ? fdopendir(fd) : nullptr;
+        if (!d)
+        {
+            if (fd >= 0)
+                ::close(fd);
+            out.report.errors++;
+            return;
+        }
+        fd_guard dst(::open(dir.dst.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC));
+        fd_guard prev(dir.prev.empty() ? -1 : ::open(dir.prev.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC));
+        if (dst.get() < 0)
+        {
+            closedir(d);
+            out.report.errors++;
+            return;
+        }
+
+        while (auto e = readdir(d))
+        {
+            if (std::strcmp(e->d_name, ".") == 0 || std::strcmp(e->d_name, "..") == 0)
+                continue;
+            struct stat st;
+            if (fstatat(fd, e->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+            {
+                out.report.errors++;
+                continue;
+            }
+            if (S_ISDIR(st.st_mode) && st.st_dev == m_root_dev && st.st_ino == m_root_ino)
+                continue; // the copy itself, it would be copied into itself forever
+            if (S_ISDIR(st.st_mode))
+            {
+                // Owner access until the fixup, so entries can still be written below it
+                if (mkdirat(dst.get(), e->d_name, 0700 | (st.st_mode & 0777)) != 0 && errno != EEXIST)
+                {
+                    out.report.errors++;
+                    continue;
+                }
+                auto path = join(dir.dst, e->d_name);
+                out.dirs.push_back(dir_fixup{path, st.st_mode & 07777, {st.st_atim, st.st_mtim}, dir.depth + 1});
+                found.push_back(item{join(dir.src, e->d_name), path,
+                                     prev.get() < 0 ? std::string() : join(dir.prev, e->d_name), dir.depth + 1});
+                out.report.dirs++;
+            }
+            else if (S_ISREG(st.st_mode))
+            {
+                if (!link_from(prev.get(), dst.get(), e->d_name, st, out.report))
+                    copy_from(fd, dst.get(), e->d_name, st, out.report);
+            }
+            else if (S_ISLNK(st.st_mode))
+            {
+                copy_link(fd, dst.get(), e->d_name, st, out.report);
+            }
+            else if (make_room(dst.get(), e->d_name))
+            {
+                if (mknodat(dst.get(), e->d_name, st.st_mode, st.st_rdev) != 0)
+                    out.report.errors++;
+                else
+                    set_times(dst.get(), e->d_name, st, AT_SYMLINK_NOFOLLOW);
+            }
+        }
+        closedir(d);
+    }
+
+private:
+    /// Removes an old entry in the way of @p name. @return false if it must be kept.
+    bool make_room(int dst, const char* name)
+    {
+        if (!m_options.overwrite)
+            return faccessat(dst, name, F_OK, AT_SYMLINK_NOFOLLOW) != 0;
+        return unlinkat(dst, name, 0) == 0 || errno == ENOENT;
+    }
+
+    void set_times(int dst, const char* name, const struct stat& st, int flags)
+    {
+        if (!m_options.preserve_times)
+            return;
+        struct timespec times[2] = {st.st_atim, st.st_mtim};
+        utimensat(dst, name, times, flags);
+    }
+
+    void set_metadata(int out, const struct stat& st)
+    {
+        if (m_options.preserve_mode)
+            ::fchmod(out, st.st_mode & 07777);
+        if (m_options.preserve_times)
+        {
+            struct timespec times[2] = {st.st_atim, st.st_mtim};
+            ::futimens(out, times);
+        }
+    }
+
+    /// Takes @p name from the previous snapshot when it is unchanged there
+    bool link_from(int prev, int dst, const char* name, const struct stat& st, copy_report& report)
+    {
+        struct stat old;
+        if (prev < 0 || fstatat(prev, name, &old, AT_SYMLINK_NOFOLLOW) != 0 || !S_ISREG(old.st_mode) ||
+            old.st_size != st.st_size || !same_times(old.st_mtim, st.st_mtim) ||
+            (old.st_mode & 07777) != (st.st_mode & 07777))
+            return false;
+        if (!make_room(dst, name))
+            return true; // kept as it is, like a copy would be
+
+        if (m_options.link == snapshot_link::hardlink)
+        {
+            // EXDEV or EMLINK fall back to a copy
+            if (linkat(prev, name, dst, name, 0) != 0)
+                return false;
+        }
+        else
+        {
+            fd_guard in(openat(prev, name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+            if (in.get() < 0)
+                return false;
+            fd_guard out(openat(dst, name, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0600));
+            if (out.get() < 0)
+                return false;
+            if (!clone(in.get(), out.get()))
+            {
+                unlinkat(dst, name, 0);
+                return false;
+            }
+            set_metadata(out.get(), st);
+            report.cloned++;
+        }
+        report.files++;
+        report.linked++;
+        return true;
+    }
+
+    void copy_from(int src, int dst, const char* name, const struct stat& st, copy_report& report)
+    {
+        metrics::detail::scope m(metrics::op::copy_file);
+        if (!make_room(dst, name))
+            return;
+        fd_guard in(openat(src, name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC));
+        if (in.get() < 0)
+        {
+            report.errors++;
+            m.failed();
+            return;
+        }
+        fd_guard out(openat(dst, name, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, st.st_mode & 0777));
+        if (out.get() < 0)
+        {
+            report.errors++;
+            m.failed();
+            return;
+        }
+
+        uint64_t bytes = 0;
+        bool cloned    = m_options.reflink && st.st_size > 0 && clone(in.get(), out.get());
+        if (!cloned && !copy_data(in.get(), out.get(), st, m_options.sparse, bytes))
+        {
+            // A partial file would pass for a good copy in the next snapshot
+            unlinkat(dst, name, 0);
+            report.errors++;
+            m.failed();
+            return;
+        }
+        set_metadata(out.get(), st);
+        m.bytes(bytes);
+        report.files++;
+        report.bytes += bytes;
+        if (cloned)
+            report.cloned++;
+    }
+
+    void copy_link(int src, int dst, const char* name, const struct stat& st, copy_report& report)
+    {
+        std::vector<char> target(static_cast<std::size_t>(st.st_size > 0 ? st.st_size : 255) + 1);
+        auto n = readlinkat(src, name, target.data(), target.size());
+        if (n < 0 || static_cast<std::size_t>(n) >= target.size())
+        {
+            report.errors++;
+            return;
+        }
+        target[static_cast<std::size_t>(n)] = '\0';
+        if (!make_room(dst, name))
+            return;
+        if (symlinkat(target.data(), dst, name) != 0)
+        {
+            report.errors++;
+            return;
+        }
+        set_times(dst, name, st, AT_SYMLINK_NOFOLLOW);
+        report.symlinks++;
+    }
+
+    const copy_options& m_options;
+    const dev_t m_root_dev;
+    const ino_t m_root_ino;
+};
+
+} // namespace
+#endif
+
+copy_report copy_tree(const std::string& src, const std::string& dst, const copy_options& options)
+{
+    copy_report report;
+#ifdef _WIN32
+    (void)src;
+    (void)dst;
+    (void)options;
+    report.errors = 1;
+    return report;
+#else
+    struct stat st, out;
+    if (::stat(src.c_str(), &st) != 0 || !S_ISDIR(st.st_mode) ||
+        (mkdir(dst.c_str(), 0700 | (st.st_mode & 0777)) != 0 && errno != EEXIST) ||
+        ::stat(dst.c_str(), &out) != 0 || !S_ISDIR(out.st_mode) || (out.st_dev == st.st_dev && out.st_ino == st.st_ino))
+    {
+        report.errors = 1;
+        return report;
+    }
+
+    copier c(options, out);
+    detail::work_stack<item> todo("os::file::copy_tree");
+    std::vector<item> root{item{src, dst, options.link_dest, 0}};
+    todo.push(root);
+
+    std::unique_ptr<thread_pool> own;
+    auto& pool   = detail::pool_or_temporary(options.pool, options.threads, own);
+    auto workers = pool.size() + 1; // parallel_for runs on the caller as well
+    std::vector<local> locals(workers);
+    pool.parallel_for(0, workers, [&c, &todo, &locals](std::size_t i) {
+        auto& out = locals[i];
+        todo.drain([&c, &out](item& dir, std::vector<item>& found) { c.scan(dir, out, found); });
+    }, 1);
+
+    // Deepest first: a parent made read only must not hide its children from the fixup
+    std::vector<dir_fixup> dirs{dir_fixup{dst, st.st_mode & 07777, {st.st_atim, st.st_mtim}, 0}};
+    report.dirs = 1;
+    for (auto& l : locals)
+    {
+        report += l.report;
+        std::move(l.dirs.begin(), l.dirs.end(), std::back_inserter(dirs));
+    }
+    std::sort(dirs.begin(), dirs.end(), [](const dir_fixup& a, const dir_fixup& b) { return a.depth > b.depth; });
+    for (auto& d : dirs)
+    {
+        if (options.preserve_mode)
+            ::chmod(d.path.c_str(), d.mode);
+        if (options.preserve_times)
+            utimensat(AT_FDCWD, d.path.c_str(), d.times, 0);
+    }
+    return report;
+#endif
+}
+
+} // namespace file
+} // namespace os
@@ -0,0 +1,126 @@
+// cpu_features.cpp
+//
+
+#include "osal/cpu_features.h"
+#include "x86_cpuid.h"
+#include <cstdlib>
+#include <cstring>
+
+namespace os {
+
+namespace detail {
+std::atomic<uint32_t> tier_generation{0};
+} // namespace detail
+
+static cpu_features detect()
+{
+    cpu_features f{};
+#if OSAL_HAS_TSC
+    unsigned regs[4];
+    detail::cpuid(0, 0, regs);
+    auto max_leaf = regs[0];
+
+    detail::cpuid(1, 0, regs);
+    f.sse2   = (regs[3] & (1u << 26)) != 0;
+    f.sse3   = (regs[2] & (1u << 0)) != 0;
+    f.ssse3  = (regs[2] & (1u << 9)) != 0;
+    f.fma    = (regs[2] & (1u << 12)) != 0;
+    f.sse41  = (regs[2] & (1u << 19)) != 0;
+    f.sse42  = (regs[2] & (1u << 20)) != 0;
+    f.popcnt = (regs[2] & (1u << 23)) != 0;
+
+    // The wide registers are only usable if the OS saves them on context switches
+    bool osxsave   = (regs[2] & (1u << 27)) != 0;
+    uint64_t xcr0  = osxsave ? detail::xgetbv() : 0;
+    bool ymm_saved = (xcr0 & 0x06) == 0x06;
+    bool zmm_saved = (xcr0 & 0xe6) == 0xe6;
+    f.avx          = ymm_saved && (regs[2] & (1u << 28)) != 0;
+    f.fma          = f.fma && f.avx;
+
+    if (max_leaf >= 7)
+    {
+        detail::cpuid(7, 0, regs);
+        f.bmi1     = (regs[1] & (1u << 3)) != 0;
+        f.avx2     = f.avx && (regs[1] & (1u << 5)) != 0;
+        f.bmi2     = (regs[1] & (1u << 8)) != 0;
+        f.avx512f  = zmm_saved && (regs[1] & (1u << 16)) != 0;
+        f.avx512bw = f.avx512f && (regs[1] & (1u << 30)) != 0;
+        f.avx512vl = f.avx512f && (regs[1] & (1u << 31)) != 0;
+    }
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    f.neon = true;
+#endif
+    return f;
+}
+
+const cpu_features& cpu_features::host()
+{
+    static const cpu_features f = detect();
+    return f;
+}
+
+static const char* const tier_names[] = {"scalar", "sse2", "sse42", "avx2", "avx512"};
+
+const char* tier_name(simd_tier t)
+{
+    auto i = static_cast<std::size_t>(t);
+    return i < static_cast<std::size_t>(simd_tier::count) ? tier_names[i] : "unknown";
+}
+
+simd_tier host_tier()
+{
+    auto& f = cpu_features::host();
+    if (f.avx512f && f.avx512bw && f.avx512vl && f.avx2 && f.bmi2)
+        return simd_tier::avx512;
+    if (f.avx2 && f.fma && f.bmi1 && f.bmi2)
+        return simd_tier::avx2;
+    if (f.sse42 && f.popcnt)
+        return simd_tier::sse42;
+    if (f.sse2)
+        return simd_tier::sse2;
+    return simd_tier::scalar;
+}
+
+static const int not_forced = -1;
+
+static int tier_from_env()
+{
+    auto env = std::getenv("OSAL_SIMD_TIER");
+    if (!env)
+        return not_forced;
+    for (std::size_t i = 0; i < static_cast<std::size_t>(simd_tier::count); i++)
+    {
+        if (std::strcmp(env, tier_names[i]) == 0)
+            return static_cast<int>(i);
+    }
+    return not_forced;
+}
+
+static std::atomic<int>& forced()
+{
+    static std::atomic<int> tier{tier_from_env()};
+    return tier;
+}
+
+simd_tier active_tier()
+{
+    auto host        = host_tier();
+    auto forced_tier = forced().load(std::memory_order_relaxed);
+    if (forced_tier != not_forced && forced_tier < static_cast<int>(host))
+        return static_cast<simd_tier>(forced_tier);
+    return host;
+}
+
+void force_tier(simd_tier t)
+{
+    forced().store(static_cast<int>(t), std::memory_order_relaxed);
+    detail::tier_generation.fetch_add(1, std::memory_order_release);
+}
+
+void clear_forced_tier()
+{
+    forced().store(not_forced, std::memory_order_relaxed);
+    detail::tier_generation.fetch_add(1, std::memory_order_release);
+}
+
+} // namespace os
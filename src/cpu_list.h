@@ -0,0 +1,61 @@
+// cpu_list.h
+//
+
+#ifndef OSAL_CPU_LIST_H
+#define OSAL_CPU_LIST_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+namespace os {
+namespace detail {
+
+/// @brief Parse a kernel cpu list such as "0-3,8,10-11" into ascending ids
+inline std::vector<unsigned> parse_cpu_list(const char* text)
+{
+    std::vector<unsigned> cpus;
+    auto p = text;
+    while (p && *p)
+    {
+        char* end;
+        auto first = std::strtoul(p, &end, 10);
+        if (end == p)
+            break;
+        auto last = first;
+        p         = end;
+        if (*p == '-')
+        {
+            last = std::strtoul(p + 1, &end, 10);
+            p    = end;
+        }
+        for (auto c = first; c <= last; c++)
+            cpus.push_back(static_cast<unsigned>(c));
+        if (*p != ',')
+            break;
+        p++;
+    }
+    return cpus;
+}
+
+/// @brief First line of a small sysfs or procfs file, without the newline, empty on failure
+inline std::string read_line(const char* path)
+{
+    std::string line;
+    if (auto fd = std::fopen(path, "r"))
+    {
+        char buf[4096];
+        if (std::fgets(buf, sizeof(buf), fd))
+            line = buf;
+        std::fclose(fd);
+    }
+    while (!line.empty() && (line.back() == '\n' || line.back() == '\r'))
+        line.pop_back();
+    return line;
+}
+
+} // namespace detail
+} // namespace os
+
+#endif // OSAL_CPU_LIST_H
@@ -0,0 +1,238 @@
+// disk_usage.cpp
+//
+
+#include "osal/disk_usage.h"
+#include "osal/os.h"
+#include "work_stack.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <unordered_set>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace os {
+namespace file {
+
+#ifndef _WIN32
+namespace {
+
+struct entry_stat {
+    bool ok;
+    bool is_dir;
+    uint32_t nlink;
+    uint64_t size;
+    uint64_t blocks; ///< 512 byte units
+    uint64_t dev;
+    uint64_t ino;
+};
+
+/// One statx relative to the open directory, fstatat where statx is missing
+entry_stat stat_at(int dirfd, const char* name)
+{
+    entry_stat s{};
+#if defined(__linux__) && defined(STATX_BASIC_STATS)
+    struct statx sx;
+    const unsigned mask = STATX_TYPE | STATX_SIZE | STATX_BLOCKS | STATX_INO | STATX_NLINK;
+    if (statx(dirfd, name, AT_SYMLINK_NOFOLLOW | AT_NO_AUTOMOUNT | AT_STATX_DONT_SYNC, mask, &sx) != 0)
+        return s;
+    s.is_dir = S_ISDIR(sx.stx_mode);
+    s.nlink  = sx.stx_nlink;
+    s.size   = sx.stx_size;
+    s.blocks = sx.stx_blocks;
+    s.dev    = (static_cast<uint64_t>(sx.stx_dev_major) << 32) | sx.stx_dev_minor;
+    s.ino    = sx.stx_ino;
+#else
+    struct stat st;
+    if (fstatat(dirfd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+        return s;
+    s.is_dir = S_ISDIR(st.st_mode);
+    s.nlink  = static_cast<uint32_t>(st.st_nlink);
+    s.size   = static_cast<uint64_t>(st.st_size);
+    s.blocks = static_cast<uint64_t>(st.st_blocks);
+    s.dev    = static_cast<uint64_t>(st.st_dev);
+    s.ino    = static_cast<uint64_t>(st.st_ino);
+#endif
+    s.ok = true;
+    return s;
+}
+
+/// Inodes with several links that were counted already
+class link_set {
+public:
+    /// @return true the first time @p dev, @p ino is seen
+    bool insert(uint64_t dev, uint64_t ino)
+    {
+        auto key = std::make_pair(dev, ino);
+        auto& s  = m_shards[hasher()(key) % shards];
+        recursive_mutex_lock lock(s.mtx);
+        return s.seen.insert(key).second;
+    }
+
+private:
+    struct hasher {
+        std::size_t operator()(const std::pair<uint64_t, uint64_t>& k) const
+        {
+            return std::hash<uint64_t>()(k.second ^ (k.first * 0x9e3779b97f4a7c15ull));
+        }
+    };
+    struct shard {
+        shard()
+            : mtx("os::file::disk_usage")
+        {}
+        os::recursive_mutex mtx;
+        std::unordered_set<std::pair<uint64_t, uint64_t>, hasher> seen;
+    };
+    static constexpr std::size_t shards = 16;
+    shard m_shards[shards];
+};
+
+constexpr std::size_t link_set::shards;
+
+/// A directory still to be read and the breakdown slot it adds to, 0 for the root itself
+struct item {
+    std::string path;
+    std::size_t slot;
+};
+
+/// Directories waiting to be read, shared by the workers
+class walker {
+public:
+    walker(const usage_options& options, uint64_t root_dev)
+        : m_options(options)
+        , m_root_dev(root_dev)
+    {}
+
+    /// Adds up the entries of @p dir into @p local and collects its subdirectories in @p found.
+    /// With @p names every subdirectory gets a breakdown slot of its own, named there.
+    void scan(const item& dir, std::vector<usage>& local, std::vector<item>& found, std::vector<std::string>* names)
+    {
+        int fd = ::open(dir.path.c_str(), O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        auto d = fd >= 0 ? fdopendir(fd) : nullptr;
+        if (!d)
+        {
+            if (fd >= 0)
+                ::close(fd);
+            at(local, dir.slot).errors++;
+            return;
+        }
+        while (auto e = readdir(d))
+        {
+            if (std::strcmp(e->d_name, ".") == 0 || std::strcmp(e->d_name, "..") == 0)
+                continue;
+            auto s    = stat_at(fd, e->d_name);
+            auto slot = dir.slot;
+            if (s.ok && s.is_dir && names)
+            {
+                names->push_back(e->d_name);
+                slot = names->size();
+            }
+            auto& u = at(local, slot);
+            if (!s.ok)
+            {
+                u.errors++;
+                continue;
+            }
+            if (s.is_dir)
+            {
+                u.dirs++;
+                if (!m_options.one_file_system || s.dev == m_root_dev)
+                    found.push_back(item{join(dir.path, e->d_name), slot});
+            }
+            else
+            {
+                if (m_options.count_links_once && s.nlink > 1 && !m_links.insert(s.dev, s.ino))
+                    continue;
+                u.files++;
+            }
+            u.apparent_bytes += s.size;
+            u.allocated_bytes += s.blocks * 512;
+        }
+        closedir(d);
+    }
+
+    /// Reads directories until none are queued or being read
+    void work(std::vector<usage>& local)
+    {
+        m_todo.drain([this, &local](item& dir, std::vector<item>& found) { scan(dir, local, found, nullptr); });
+    }
+
+    void push(std::vector<item>& items) { m_todo.push(items); }
+
+    static usage& at(std::vector<usage>& local, std::size_t slot)
+    {
+        if (local.size() <= slot)
+            local.resize(slot + 1);
+        return local[slot];
+    }
+
+private:
+    const usage_options& m_options;
+    const uint64_t m_root_dev;
+    link_set m_links;
+    detail::work_stack<item> m_todo{"os::file::disk_usage"};
+};
+
+} // namespace
+#endif
+
+usage_report disk_usage(const std::string& path, const usage_options& options)
+{
+    usage_report report;
+#ifdef _WIN32
+    (void)path;
+    (void)options;
+    report.total.errors = 1;
+    return report;
+#else
+    auto root = stat_at(AT_FDCWD, path.c_str());
+    if (!root.ok || !root.is_dir)
+    {
+        report.total.errors = 1;
+        return report;
+    }
+
+    walker w(options, root.dev);
+    std::vector<usage> slots(1);
+    slots[0].dirs            = 1;
+    slots[0].apparent_bytes  = root.size;
+    slots[0].allocated_bytes = root.blocks * 512;
+
+    // The root is read up front so its subdirectories can get breakdown slots
+    std::vector<item> found;
+    std::vector<std::string> names;
+    w.scan(item{path, 0}, slots, found, options.breakdown ? &names : nullptr);
+
+    if (!found.empty())
+    {
+        std::unique_ptr<thread_pool> own;
+        auto& pool   = detail::pool_or_temporary(options.pool, options.threads, own);
+        auto workers = pool.size() + 1; // parallel_for runs on the caller as well
+        std::vector<std::vector<usage>> locals(workers);
+        w.push(found);
+        pool.parallel_for(0, workers, [&w, &locals](std::size_t i) { w.work(locals[i]); }, 1);
+
+        for (auto& local : locals)
+        {
+            for (std::size_t i = 0; i < local.size(); i++)
+                walker::at(slots, i) += local[i];
+        }
+    }
+
+    for (auto& u : slots)
+        report.total += u;
+    for (std::size_t i = 0; i < names.size(); i++)
+        report.subdirs.emplace_back(names[i], walker::at(slots, i + 1));
+    std::sort(report.subdirs.begin(), report.subdirs.end(),
+              [](const std::pair<std::string, usage>& a, const std::pair<std::string, usage>& b) { return a.first < b.first; });
+    return report;
+#endif
+}
+
+} // namespace file
+} // namespace os
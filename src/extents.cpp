@@ -0,0 +1,234 @@
+// extents.cpp
+//
+
+#include "osal/extents.h"
+#include "osal/io_metrics.h"
+#include "osal/os.h"
+#include "fd_guard.h"
+#include <algorithm>
+#include <cerrno>
+#include <memory>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#include <linux/falloc.h>
+#endif
+
+namespace os {
+namespace file {
+
+#ifndef _WIN32
+namespace {
+
+using detail::fd_guard;
+
+bool preallocate_fd(int fd, uint64_t offset, uint64_t len, bool keep_size)
+{
+    if (len == 0)
+        return true;
+#ifdef __linux__
+    if (::fallocate(fd, keep_size ? FALLOC_FL_KEEP_SIZE : 0, static_cast<off_t>(offset), static_cast<off_t>(len)) == 0)
+        return true;
+    if (errno != EOPNOTSUPP || keep_size)
+        return false;
+    // glibc emulates this by writing a zero into every block, slow but the file ends up allocated
+    return ::posix_fallocate(fd, static_cast<off_t>(offset), static_cast<off_t>(len)) == 0;
+#else
+    (void)fd;
+    (void)offset;
+    (void)len;
+    (void)keep_size;
+    return false;
+#endif
+}
+
+bool punch_hole_fd(int fd, uint64_t offset, uint64_t len)
+{
+#if defined(__linux__) && defined(FALLOC_FL_PUNCH_HOLE)
+    return len == 0 ||
+           ::fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, static_cast<off_t>(offset),
+                       static_cast<off_t>(len)) == 0;
+#else
+    (void)fd;
+    (void)offset;
+    (void)len;
+    return false;
+#endif
+}
+
+std::vector<extent> extents_fd(int fd, uint64_t size)
+{
+    std::vector<extent> out;
+#ifdef SEEK_DATA
+    uint64_t offset = 0;
+    while (offset < size)
+    {
+        auto data = ::lseek(fd, static_cast<off_t>(offset), SEEK_DATA);
+        if (data < 0 && errno == ENXIO)
+            return out; // only a hole is left
+        if (data < 0)
+            break;
+        auto hole = ::lseek(fd, data, SEEK_HOLE);
+        auto end  = hole < 0 ? size : std::min(static_cast<uint64_t>(hole), size);
+        out.push_back(extent{static_cast<uint64_t>(data), end - static_cast<uint64_t>(data)});
+        offset = end;
+    }
+    if (offset >= size)
+        return out;
+    out.clear(); // not supported here
+#endif
+    if (size > 0)
+        out.push_back(extent{0, size});
+    return out;
+}
+
+} // namespace
+#endif
+
+bool preallocate(FILE* fd, uint64_t offset, uint64_t len, bool keep_size)
+{
+#ifdef _WIN32
+    (void)fd;
+    (void)offset;
+    (void)len;
+    (void)keep_size;
+    return false;
+#else
+    return fd && preallocate_fd(fileno(fd), offset, len, keep_size);
+#endif
+}
+
+bool preallocate(const std::string& path, uint64_t size, bool keep_size)
+{
+#ifdef _WIN32
+    (void)path;
+    (void)size;
+    (void)keep_size;
+    return false;
+#else
+    fd_guard fd(::open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0666));
+    return fd.get() >= 0 && preallocate_fd(fd.get(), 0, size, keep_size);
+#endif
+}
+
+bool punch_hole(FILE* fd, uint64_t offset, uint64_t len)
+{
+#ifdef _WIN32
+    (void)fd;
+    (void)offset;
+    (void)len;
+    return false;
+#else
+    if (!fd || fflush(fd) != 0) // buffered writes into the range would land after the punch
+        return false;
+    return punch_hole_fd(fileno(fd), offset, len);
+#endif
+}
+
+bool punch_hole(const std::string& path, uint64_t offset, uint64_t len)
+{
+#ifdef _WIN32
+    (void)path;
+    (void)offset;
+    (void)len;
+    return false;
+#else
+    fd_guard fd(::open(path.c_str(), O_WRONLY | O_CLOEXEC));
+    return fd.get() >= 0 && punch_hole_fd(fd.get(), offset, len);
+#endif
+}
+
+std::vector<extent> data_extents(const std::string& path)
+{
+#ifdef _WIN32
+    auto s = size(path);
+    return s > 0 ? std::vector<extent>{extent{0, s}} : std::vector<extent>();
+#else
+    fd_guard fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat st;
+    if (fd.get() < 0 || ::fstat(fd.get(), &st) != 0)
+        return std::vector<extent>();
+    return extents_fd(fd.get(), static_cast<uint64_t>(st.st_size));
+#endif
+}
+
+bool for_each_data(const std::string& path, const std::function<void(uint64_t offset, string_ref data)>& fn,
+                   std::size_t chunk)
+{
+    metrics::detail::scope m(metrics::op::read);
+    chunk = std::max<std::size_t>(chunk, 1);
+    uint64_t total = 0;
+#ifdef _WIN32
+    auto fd = file::open(path.c_str(), "rb");
+    if (!fd)
+        return m.result(false);
+    std::unique_ptr<char[]> buf(new char[chunk]);
+    bool ok = true;
+    for (uint64_t offset = 0;;)
+    {
+        auto n = fread(buf.get(), 1, chunk, fd);
+        if (n > 0)
+            fn(offset, string_ref(buf.get(), n));
+        offset += n;
+        total += n;
+        if (n < chunk)
+        {
+            ok = !ferror(fd);
+            break;
+        }
+    }
+    file::close(fd);
+    m.bytes(total);
+    return m.result(ok);
+#else
+    fd_guard fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat st;
+    if (fd.get() < 0 || ::fstat(fd.get(), &st) != 0)
+        return m.result(false);
+
+    chunk = static_cast<std::size_t>(std::min<uint64_t>(chunk, static_cast<uint64_t>(st.st_size)));
+    std::unique_ptr<char[]> buf(new char[chunk]);
+    for (auto& e : extents_fd(fd.get(), static_cast<uint64_t>(st.st_size)))
+    {
+        for (uint64_t done = 0; done < e.size;)
+        {
+            auto want = static_cast<std::size_t>(std::min<uint64_t>(chunk, e.size - done));
+            auto n    = ::pread(fd.get(), buf.get(), want, static_cast<off_t>(e.offset + done));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n < 0)
+            {
+                m.bytes(total);
+                return m.result(false);
+            }
+            if (n == 0)
+                break; // truncated while reading
+            fn(e.offset + done, string_ref(buf.get(), static_cast<std::size_t>(n)));
+            done += static_cast<uint64_t>(n);
+            total += static_cast<uint64_t>(n);
+        }
+    }
+    m.bytes(total);
+    return true;
+#endif
+}
+
+uint64_t allocated_size(const std::string& path)
+{
+#ifdef _WIN32
+    return size(path);
+#else
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0)
+        return 0;
+    return static_cast<uint64_t>(st.st_blocks) * 512;
+#endif
+}
+
+} // namespace file
+} // namespace os
@@ -0,0 +1,36 @@
+// fd_guard.h
+//
+
+#ifndef OSAL_FD_GUARD_H
+#define OSAL_FD_GUARD_H
+
+#ifndef _WIN32
+#include <unistd.h>
+
+namespace os {
+namespace detail {
+
+/// @brief Closes a descriptor on scope exit
+class fd_guard {
+public:
+    explicit fd_guard(int fd)
+        : m_fd(fd)
+    {}
+    fd_guard(const fd_guard& other) = delete;
+    fd_guard& operator=(const fd_guard& other) = delete;
+    ~fd_guard()
+    {
+        if (m_fd >= 0)
+            ::close(m_fd);
+    }
+    int get() const { return m_fd; }
+
+private:
+    int m_fd;
+};
+
+} // namespace detail
+} // namespace os
+#endif
+
+#endif // OSAL_FD_GUARD_H
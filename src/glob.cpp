@@ -0,0 +1,478 @@
+// glob.cpp
+//
+
+#include "osal/glob.h"
+#include "osal/io_metrics.h"
+#include "osal/os.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif
+
+namespace os {
+namespace file {
+
+namespace {
+
+/// Index of the ] closing the set that starts at @p open, npos if it is unclosed
+std::size_t set_end(string_ref p, std::size_t open)
+{
+    auto i = open + 1;
+    if (i < p.size() && (p[i] == '!' || p[i] == '^'))
+        i++;
+    if (i < p.size() && p[i] == ']') // a leading ] is a member
+        i++;
+    for (; i < p.size(); i++)
+    {
+        if (p[i] == ']')
+            return i;
+        if (p[i] == '/')
+            break;
+    }
+    return std::string::npos;
+}
+
+/// Expands the first top level {a,b} of @p p into @p out, recursively
+void expand_braces(const std::string& p, std::vector<std::string>& out)
+{
+    for (std::size_t i = 0; i < p.size(); i++)
+    {
+        if (p[i] == '\\')
+        {
+            i++;
+            continue;
+        }
+        if (p[i] == '[')
+        {
+            auto end = set_end(p, i);
+            if (end != std::string::npos)
+                i = end;
+            continue;
+        }
+        if (p[i] != '{')
+            continue;
+
+        // Find the matching } and the top level commas in between
+        std::vector<std::size_t> cuts{i};
+        int depth = 0;
+        std::size_t close = std::string::npos;
+        for (auto j = i + 1; j < p.size() && close == std::string::npos; j++)
+        {
+            if (p[j] == '\\')
+                j++;
+            else if (p[j] == '{')
+                depth++;
+            else if (p[j] == '}' && depth > 0)
+                depth--;
+            else if (p[j] == '}')
+                close = j;
+            else if (p[j] == ',' && depth == 0)
+                cuts.push_back(j);
+        }
+        if (close == std::string::npos || cuts.size() == 1)
+            continue; // unclosed or without alternatives, literal
+        cuts.push_back(close);
+
+        auto prefix = p.substr(0, i);
+        auto suffix = p.substr(close + 1);
+        for (std::size_t c = 0; c + 1 < cuts.size(); c++)
+            expand_braces(prefix + p.substr(cuts[c] + 1, cuts[c + 1] - cuts[c] - 1) + suffix, out);
+        return;
+    }
+    out.push_back(p);
+}
+
+void append(std::string& path, string_ref name)
+{
+    if (!path.empty() && path.back() != '/')
+        path += '/';
+    path.append(name.data(), name.size());
+}
+
+} // namespace
+
+glob_pattern::segment glob_pattern::compile_segment(string_ref p)
+{
+    segment s;
+    s.kind     = segment::literal;
+    s.min_size = 0;
+    s.dot_ok   = !p.empty() && p[0] == '.';
+    if (p == string_ref("**"))
+    {
+        s.kind = segment::globstar;
+        return s;
+    }
+
+    auto literal = [&s](char c) {
+        if (s.tokens.empty() || s.tokens.back().kind != token::literal)
+            s.tokens.push_back(token{token::literal, static_cast<uint32_t>(s.text.size()), 0});
+        s.text.push_back(c);
+        s.tokens.back().size++;
+        s.min_size++;
+    };
+
+    for (std::size_t i = 0; i < p.size(); i++)
+    {
+        auto c = p[i];
+        if (c == '\\' && i + 1 < p.size())
+        {
+            literal(p[++i]);
+        }
+        else if (c == '?')
+        {
+            s.tokens.push_back(token{token::any_one, 0, 0});
+            s.kind = segment::wildcard;
+            s.min_size++;
+        }
+        else if (c == '*')
+        {
+            if (s.tokens.empty() || s.tokens.back().kind != token::any_run) // ** inside a name is *
+                s.tokens.push_back(token{token::any_run, 0, 0});
+            s.kind = segment::wildcard;
+        }
+        else if (c == '[' && set_end(p, i) != std::string::npos)
+        {
+            auto end = set_end(p, i);
+            charset cs{};
+            auto j      = i + 1;
+            bool negate = p[j] == '!' || p[j] == '^';
+            if (negate)
+                j++;
+            for (auto first = j; j < end; j++)
+            {
+                auto lo = static_cast<unsigned char>(p[j]);
+                if (lo == '-' && j != first && j + 1 < end) // a range, - at either end is a member
+                    continue;
+                if (j + 2 < end && p[j + 1] == '-')
+                {
+                    auto hi = static_cast<unsigned char>(p[j + 2]);
+                    for (unsigned x = lo; x <= hi; x++)
+                        cs.set(static_cast<unsigned char>(x));
+                    j += 2;
+                    continue;
+                }
+                cs.set(lo);
+            }
+            if (negate)
+            {
+                for (auto& b : cs.bits)
+                    b = ~b;
+            }
+            s.tokens.push_back(token{token::set, static_cast<uint32_t>(s.sets.size()), 0});
+            s.sets.push_back(cs);
+            s.kind = segment::wildcard;
+            s.min_size++;
+            i = end;
+        }
+        else
+        {
+            literal(c);
+        }
+    }
+    return s;
+}
+
+glob_pattern::glob_pattern(string_ref pattern)
+    : m_pattern(pattern.str())
+{
+    std::vector<std::string> expanded;
+    expand_braces(m_pattern, expanded);
+    for (auto& e : expanded)
+    {
+        alternative alt;
+        alt.absolute = !e.empty() && e[0] == '/';
+        alt.dir_only = e.size() > 1 && e.back() == '/';
+        std::size_t start = 0;
+        while (start < e.size())
+        {
+            auto slash = e.find('/', start);
+            if (slash == std::string::npos)
+                slash = e.size();
+            if (slash > start) // repeated slashes are one
+                alt.segments.push_back(compile_segment(string_ref(e.data() + start, slash - start)));
+            start = slash + 1;
+        }
+        if (!alt.segments.empty() || alt.absolute)
+            m_alternatives.push_back(std::move(alt));
+    }
+}
+
+bool glob_pattern::segment::match(string_ref name) const
+{
+    if (kind == literal)
+        return name == string_ref(text);
+    if (name.size() < min_size || (!name.empty() && name[0] == '.' && !dot_ok))
+        return false;
+
+    // Every token but * has a fixed width, so backtracking to the last * is enough
+    const auto n    = tokens.size();
+    std::size_t ti  = 0, si = 0;
+    std::size_t star_t = std::string::npos, star_s = 0;
+    for (;;)
+    {
+        if (ti < n)
+        {
+            auto& t = tokens[ti];
+            switch (t.kind)
+            {
+            case token::any_run:
+                star_t = ++ti;
+                star_s = si;
+                continue;
+            case token::any_one:
+                if (si < name.size())
+                {
+                    ti++;
+                    si++;
+                    continue;
+                }
+                break;
+            case token::set:
+                if (si < name.size() && sets[t.begin].test(static_cast<unsigned char>(name[si])))
+                {
+                    ti++;
+                    si++;
+                    continue;
+                }
+                break;
+            case token::literal:
+                if (name.size() - si >= t.size && std::memcmp(name.data() + si, text.data() + t.begin, t.size) == 0)
+                {
+                    ti++;
+                    si += t.size;
+                    continue;
+                }
+                break;
+            }
+        }
+        else if (si == name.size())
+        {
+            return true;
+        }
+        if (star_t == std::string::npos || star_s >= name.size())
+            return false;
+        ti = star_t;
+        si = ++star_s;
+    }
+}
+
+bool glob_pattern::match_from(const alternative& alt, std::size_t seg, string_ref path)
+{
+    for (; seg < alt.segments.size(); seg++)
+    {
+        auto& s = alt.segments[seg];
+        if (s.kind == segment::globstar && seg + 1 == alt.segments.size())
+        {
+            // Everything below that is not hidden
+            for (auto p = path.begin(); p != path.end(); ++p)
+            {
+                if (*p == '.' && (p == path.begin() || p[-1] == '/'))
+                    return false;
+            }
+            return !path.empty();
+        }
+        if (s.kind == segment::globstar)
+        {
+            // Zero directories, then one more on every attempt
+            for (auto rest = path;;)
+            {
+                if (match_from(alt, seg + 1, rest))
+                    return true;
+                auto slash = std::find(rest.begin(), rest.end(), '/');
+                if (slash == rest.end() || rest[0] == '.')
+                    return false;
+                rest = string_ref(slash + 1, static_cast<std::size_t>(rest.end() - slash - 1));
+            }
+        }
+        if (path.empty())
+            return false;
+        auto slash = std::find(path.begin(), path.end(), '/');
+        if (!s.match(string_ref(path.begin(), static_cast<std::size_t>(slash - path.begin()))))
+            return false;
+        path = slash == path.end() ? string_ref() : string_ref(slash + 1, static_cast<std::size_t>(path.end() - slash - 1));
+    }
+    return path.empty();
+}
+
+bool glob_pattern::match(string_ref path) const
+{
+    for (auto& alt : m_alternatives)
+    {
+        auto p = path;
+        if (alt.absolute != (!p.empty() && p[0] == '/'))
+            continue;
+        while (!p.empty() && p[0] == '/')
+            p = string_ref(p.data() + 1, p.size() - 1);
+        if (alt.dir_only && !p.empty() && p[p.size() - 1] == '/')
+            p = string_ref(p.data(), p.size() - 1);
+        if (match_from(alt, 0, p))
+            return true;
+    }
+    return false;
+}
+
+/// Walks the directories that can still lead to a match of one alternative
+class glob_walker {
+public:
+    glob_walker(const glob_pattern::alternative& alt, std::vector<std::string>& out)
+        : m_alt(alt)
+        , m_out(out)
+    {}
+
+    void run()
+    {
+        std::string path = m_alt.absolute ? "/" : "";
+        if (m_alt.segments.empty())
+            m_out.push_back(path);
+        else
+            walk(path, 0);
+    }
+
+private:
+    enum class kind { missing, dir, other };
+
+    /// Follows symbolic links like a shell does, except below **
+    static kind classify(const std::string& path, bool follow)
+    {
+        struct stat st;
+#ifdef _WIN32
+        (void)follow;
+        if (::stat(path.c_str(), &st) != 0)
+            return kind::missing;
+        return (st.st_mode & S_IFDIR) ? kind::dir : kind::other;
+#else
+        if ((follow ? ::stat(path.c_str(), &st) : ::lstat(path.c_str(), &st)) != 0)
+            return kind::missing;
+        return S_ISDIR(st.st_mode) ? kind::dir : kind::other;
+#endif
+    }
+
+    void emit(const std::string& path, bool is_dir)
+    {
+        if (!m_alt.dir_only || is_dir)
+            m_out.push_back(path);
+    }
+
+    void walk(std::string& path, std::size_t seg)
+    {
+        auto& s    = m_alt.segments[seg];
+        bool last  = seg + 1 == m_alt.segments.size();
+        auto mark  = path.size();
+        if (s.kind == glob_pattern::segment::literal)
+        {
+            // No listing needed, this is what keeps unrelated directories closed
+            append(path, s.text);
+            auto k = classify(path, true);
+            if (k != kind::missing)
+            {
+                if (last)
+                    emit(path, k == kind::dir);
+                else if (k == kind::dir)
+                    walk(path, seg + 1);
+            }
+            path.resize(mark);
+            return;
+        }
+        if (s.kind == glob_pattern::segment::globstar && !last)
+            walk(path, seg + 1); // zero directories
+        list(path, seg, last);
+    }
+
+    void list(std::string& path, std::size_t seg, bool last)
+    {
+#ifdef _WIN32
+        (void)path;
+        (void)seg;
+        (void)last;
+#else
+        auto& s      = m_alt.segments[seg];
+        bool globstar = s.kind == glob_pattern::segment::globstar;
+        auto mark     = path.size();
+
+        // Read the whole directory before descending, so its list_dir time excludes the subtree
+        std::vector<std::pair<std::string, kind>> entries;
+        {
+            metrics::detail::scope m(metrics::op::list_dir);
+            auto d = ::opendir(path.empty() ? "." : path.c_str());
+            if (!d)
+            {
+                m.failed();
+                return;
+            }
+            while (auto e = ::readdir(d))
+            {
+                string_ref name(e->d_name);
+                if (globstar ? name[0] == '.' : !s.match(name))
+                    continue;
+                if (name == string_ref(".") || name == string_ref(".."))
+                    continue;
+
+                append(path, name);
+                auto k = kind::other;
+#ifdef DT_DIR
+                if (e->d_type == DT_DIR)
+                    k = kind::dir;
+                else if (e->d_type == DT_UNKNOWN || (e->d_type == DT_LNK && !globstar))
+                    k = classify(path, !globstar);
+#else
+                k = classify(path, !globstar);
+#endif
+                path.resize(mark);
+                entries.emplace_back(name.str(), k);
+            }
+            ::closedir(d);
+        }
+
+        for (auto& entry : entries)
+        {
+            append(path, entry.first);
+            auto k = entry.second;
+            if (globstar)
+            {
+                // Trailing ** matches everything below, otherwise it only passes through
+                if (last)
+                    emit(path, k == kind::dir);
+                if (k == kind::dir)
+                    walk(path, seg);
+            }
+            else if (last)
+            {
+                emit(path, k == kind::dir);
+            }
+            else if (k == kind::dir)
+            {
+                walk(path, seg + 1);
+            }
+            path.resize(mark);
+        }
+#endif
+    }
+
+    const glob_pattern::alternative& m_alt;
+    std::vector<std::string>& m_out;
+};
+
+std::vector<std::string> glob(const glob_pattern& pattern)
+{
+    std::vector<std::string> out;
+    for (auto& alt : pattern.m_alternatives)
+        glob_walker(alt, out).run();
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+std::vector<std::string> glob(const std::string& pattern) { return glob(glob_pattern(pattern)); }
+
+} // namespace file
+} // namespace os
@@ -0,0 +1,162 @@
+// io_metrics.cpp
+//
+
+#include "osal/io_metrics.h"
+#include "osal/histogram.h"
+#include "osal/trace.h"
+#include "per_thread.h"
+#include <atomic>
+#include <cstdio>
+#include <memory>
+
+namespace os {
+namespace file {
+namespace metrics {
+
+static constexpr std::size_t op_count = static_cast<std::size_t>(op::count);
+
+const char* op_name(op o)
+{
+    static const char* names[op_count] = {
+        "open", "read", "dump", "copy_file", "list_dir", "delete_dir", "is_reg_file", "is_dir", "size"};
+    auto i = static_cast<std::size_t>(o);
+    return i < op_count ? names[i] : "unknown";
+}
+
+namespace detail {
+
+struct op_stats {
+    std::atomic<uint64_t> calls{0};
+    std::atomic<uint64_t> errors{0};
+    std::atomic<uint64_t> bytes{0};
+    histogram latency; // cycles
+};
+
+/// Written only by its thread, read by snapshot() and cleared by reset()
+struct thread_buffer {
+    void merge(const thread_buffer& other)
+    {
+        for (std::size_t i = 0; i < op_count; i++)
+        {
+            ops[i].calls.fetch_add(other.ops[i].calls.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            ops[i].errors.fetch_add(other.ops[i].errors.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            ops[i].bytes.fetch_add(other.ops[i].bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            ops[i].latency.merge(other.ops[i].latency);
+        }
+    }
+
+    void reset()
+    {
+        for (auto& o : ops)
+        {
+            o.calls.store(0, std::memory_order_relaxed);
+            o.errors.store(0, std::memory_order_relaxed);
+            o.bytes.store(0, std::memory_order_relaxed);
+            o.latency.reset();
+        }
+    }
+
+    op_stats ops[op_count];
+};
+
+using buffers = os::detail::per_thread<thread_buffer>;
+
+static void bump(std::atomic<uint64_t>& a, uint64_t n)
+{
+    a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+void record(op o, uint64_t start_cycles, uint64_t end_cycles, uint64_t bytes, bool failed)
+{
+#ifdef OSAL_TRACE
+    trace::detail::record(op_name(o), "file", start_cycles, end_cycles);
+#endif
+    auto& s = buffers::local().ops[static_cast<std::size_t>(o)];
+    bump(s.calls, 1);
+    if (failed)
+        bump(s.errors, 1);
+    if (bytes)
+        bump(s.bytes, bytes);
+    s.latency.record(end_cycles - start_cycles);
+}
+
+} // namespace detail
+
+std::vector<op_report> snapshot()
+{
+    std::unique_ptr<detail::thread_buffer> total(new detail::thread_buffer());
+    detail::buffers::for_each([&total](detail::thread_buffer& t) { total->merge(t); });
+
+    std::vector<op_report> out;
+    for (std::size_t i = 0; i < op_count; i++)
+    {
+        auto& s = total->ops[i];
+        op_report r;
+        r.operation        = static_cast<op>(i);
+        r.calls            = s.calls.load();
+        r.errors           = s.errors.load();
+        r.bytes            = s.bytes.load();
+        r.latency_total_ns = clock::cycles_to_ns(s.latency.sum());
+        r.latency_p50_ns   = clock::cycles_to_ns(s.latency.percentile(0.5));
+        r.latency_p99_ns   = clock::cycles_to_ns(s.latency.percentile(0.99));
+        r.latency_max_ns   = clock::cycles_to_ns(s.latency.max());
+        out.push_back(r);
+    }
+    return out;
+}
+
+void reset() { detail::buffers::reset(); }
+
+std::string prometheus(const std::string& prefix)
+{
+    auto ops = snapshot();
+    std::string out;
+    char line[256];
+
+    auto counter = [&](const char* name, const char* help, uint64_t op_report::*field) {
+        out += "# HELP " + prefix + "_" + name + " " + help + "\n";
+        out += "# TYPE " + prefix + "_" + name + " counter\n";
+        for (auto& o : ops)
+        {
+            snprintf(line, sizeof(line), "%s_%s{op=\"%s\"} %llu\n", prefix.c_str(), name, op_name(o.operation),
+                static_cast<unsigned long long>(o.*field));
+            out += line;
+        }
+    };
+    counter("calls_total", "Calls into os::file operations.", &op_report::calls);
+    counter("errors_total", "os::file operations that failed.", &op_report::errors);
+    counter("bytes_total", "Bytes read or written by os::file operations.", &op_report::bytes);
+
+    out += "# HELP " + prefix + "_latency_seconds Latency of os::file operations.\n";
+    out += "# TYPE " + prefix + "_latency_seconds summary\n";
+    for (auto& o : ops)
+    {
+        auto name = op_name(o.operation);
+        snprintf(line, sizeof(line), "%s_latency_seconds{op=\"%s\",quantile=\"0.5\"} %.9f\n", prefix.c_str(), name,
+            static_cast<double>(o.latency_p50_ns) / 1e9);
+        out += line;
+        snprintf(line, sizeof(line), "%s_latency_seconds{op=\"%s\",quantile=\"0.99\"} %.9f\n", prefix.c_str(), name,
+            static_cast<double>(o.latency_p99_ns) / 1e9);
+        out += line;
+        snprintf(line, sizeof(line), "%s_latency_seconds_sum{op=\"%s\"} %.9f\n", prefix.c_str(), name,
+            static_cast<double>(o.latency_total_ns) / 1e9);
+        out += line;
+        snprintf(line, sizeof(line), "%s_latency_seconds_count{op=\"%s\"} %llu\n", prefix.c_str(), name,
+            static_cast<unsigned long long>(o.calls));
+        out += line;
+    }
+
+    out += "# HELP " + prefix + "_latency_max_seconds Slowest os::file operation since the last reset.\n";
+    out += "# TYPE " + prefix + "_latency_max_seconds gauge\n";
+    for (auto& o : ops)
+    {
+        snprintf(line, sizeof(line), "%s_latency_max_seconds{op=\"%s\"} %.9f\n", prefix.c_str(),
+            op_name(o.operation), static_cast<double>(o.latency_max_ns) / 1e9);
+        out += line;
+    }
+    return out;
+}
+
+} // namespace metrics
+} // namespace file
+} // namespace os
@@ -0,0 +1,234 @@
+// lock_stats.cpp
+//
+
+#include "osal/lock_stats.h"
+#include "osal/clock.h"
+#include "osal/histogram.h"
+#include "per_thread.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace os {
+namespace lock_stats {
+
+#ifdef OSAL_LOCK_STATS
+bool enabled() { return true; }
+#else
+bool enabled() { return false; }
+#endif
+
+namespace detail {
+
+/// Sites past this limit are folded into the last one
+static constexpr std::size_t max_sites = 1024;
+
+struct site {
+    std::size_t index;
+    std::string name;
+};
+
+struct site_stats {
+    std::atomic<uint64_t> acquires{0};
+    std::atomic<uint64_t> contended{0};
+    std::atomic<uint64_t> temporary_unlocks{0};
+    histogram wait;
+    histogram hold;
+
+    void reset()
+    {
+        acquires.store(0, std::memory_order_relaxed);
+        contended.store(0, std::memory_order_relaxed);
+        temporary_unlocks.store(0, std::memory_order_relaxed);
+        wait.reset();
+        hold.reset();
+    }
+
+    void merge(const site_stats& other)
+    {
+        acquires.fetch_add(other.acquires.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        contended.fetch_add(other.contended.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        temporary_unlocks.fetch_add(other.temporary_unlocks.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        wait.merge(other.wait);
+        hold.merge(other.hold);
+    }
+};
+
+/// Written only by its thread, read by snapshot() and cleared by reset()
+struct thread_buffer {
+    thread_buffer()
+    {
+        for (auto& s : sites)
+            s.store(nullptr, std::memory_order_relaxed);
+    }
+    ~thread_buffer()
+    {
+        for (auto& s : sites)
+            delete s.load(std::memory_order_relaxed);
+    }
+
+    site_stats& at(std::size_t index)
+    {
+        auto s = sites[index].load(std::memory_order_acquire);
+        if (!s)
+        {
+            s = new site_stats();
+            sites[index].store(s, std::memory_order_release);
+        }
+        return *s;
+    }
+
+    void merge(const thread_buffer& other)
+    {
+        for (std::size_t i = 0; i < max_sites; i++)
+        {
+            if (auto s = other.sites[i].load(std::memory_order_acquire))
+                at(i).merge(*s);
+        }
+    }
+
+    void reset()
+    {
+        for (auto& s : sites)
+        {
+            if (auto st = s.load(std::memory_order_acquire))
+                st->reset();
+        }
+    }
+
+    std::atomic<site_stats*> sites[max_sites];
+};
+
+using buffers = os::detail::per_thread<thread_buffer>;
+
+struct registry {
+    std::mutex mtx;
+    std::map<std::string, std::unique_ptr<site>> by_name;
+    std::vector<site*> by_index;
+};
+
+static registry& get_registry()
+{
+    static registry* r = new registry(); // never destroyed, mutexes may outlive static teardown
+    return *r;
+}
+
+static site_stats& local(site* s) { return buffers::local().at(s->index); }
+
+site* register_site(const char* name)
+{
+    std::string key = name ? name : "(unnamed)";
+    auto& r = get_registry();
+    std::lock_guard<std::mutex> lock(r.mtx);
+
+    auto it = r.by_name.find(key);
+    if (it != r.by_name.end())
+        return it->second.get();
+
+    if (r.by_index.size() == max_sites - 1)
+        key = "(other)";
+    if (r.by_index.size() >= max_sites)
+        return r.by_index.back();
+
+    std::unique_ptr<site> s(new site{r.by_index.size(), key});
+    r.by_index.push_back(s.get());
+    auto raw = s.get();
+    r.by_name[key] = std::move(s);
+    return raw;
+}
+
+void record_acquire(site* s, bool contended, uint64_t wait_cycles)
+{
+    auto& st = local(s);
+    st.acquires.store(st.acquires.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (contended)
+        st.contended.store(st.contended.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    st.wait.record(wait_cycles);
+}
+
+void record_hold(site* s, uint64_t hold_cycles) { local(s).hold.record(hold_cycles); }
+
+void record_temporary_unlock(site* s)
+{
+    auto& st = local(s);
+    st.temporary_unlocks.store(st.temporary_unlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+std::vector<site_report> snapshot()
+{
+    std::vector<detail::site*> sites;
+    {
+        auto& r = detail::get_registry();
+        std::lock_guard<std::mutex> lock(r.mtx);
+        sites = r.by_index;
+    }
+
+    std::vector<site_report> out;
+    for (auto s : sites)
+    {
+        detail::site_stats total;
+        detail::buffers::for_each([&total, s](detail::thread_buffer& t) {
+            if (auto st = t.sites[s->index].load(std::memory_order_acquire))
+                total.merge(*st);
+        });
+        if (total.acquires.load() == 0)
+            continue;
+
+        // Samples are in cycles, convert on the way out
+        site_report rep;
+        rep.name              = s->name;
+        rep.acquires          = total.acquires.load();
+        rep.contended         = total.contended.load();
+        rep.temporary_unlocks = total.temporary_unlocks.load();
+        rep.wait_total_ns     = clock::cycles_to_ns(total.wait.sum());
+        rep.wait_p50_ns       = clock::cycles_to_ns(total.wait.percentile(0.5));
+        rep.wait_p99_ns       = clock::cycles_to_ns(total.wait.percentile(0.99));
+        rep.wait_max_ns       = clock::cycles_to_ns(total.wait.max());
+        rep.hold_total_ns     = clock::cycles_to_ns(total.hold.sum());
+        rep.hold_p50_ns       = clock::cycles_to_ns(total.hold.percentile(0.5));
+        rep.hold_p99_ns       = clock::cycles_to_ns(total.hold.percentile(0.99));
+        rep.hold_max_ns       = clock::cycles_to_ns(total.hold.max());
+        out.push_back(rep);
+    }
+
+    std::sort(out.begin(), out.end(),
+        [](const site_report& a, const site_report& b) { return a.wait_total_ns > b.wait_total_ns; });
+    return out;
+}
+
+std::string report()
+{
+    if (!enabled())
+        return "lock stats disabled, build osal with OSAL_LOCK_STATS\n";
+
+    std::string out;
+    char line[512];
+    snprintf(line, sizeof(line), "%-32s %12s %12s %8s %14s %10s %10s %10s %14s %10s %10s %10s\n", "mutex",
+        "acquires", "contended", "tmp_unl", "wait_total_ns", "wait_p50", "wait_p99", "wait_max", "hold_total_ns",
+        "hold_p50", "hold_p99", "hold_max");
+    out += line;
+
+    for (auto& s : snapshot())
+    {
+        snprintf(line, sizeof(line),
+            "%-32s %12llu %12llu %8llu %14llu %10llu %10llu %10llu %14llu %10llu %10llu %10llu\n", s.name.c_str(),
+            static_cast<unsigned long long>(s.acquires), static_cast<unsigned long long>(s.contended),
+            static_cast<unsigned long long>(s.temporary_unlocks), static_cast<unsigned long long>(s.wait_total_ns),
+            static_cast<unsigned long long>(s.wait_p50_ns), static_cast<unsigned long long>(s.wait_p99_ns),
+            static_cast<unsigned long long>(s.wait_max_ns), static_cast<unsigned long long>(s.hold_total_ns),
+            static_cast<unsigned long long>(s.hold_p50_ns), static_cast<unsigned long long>(s.hold_p99_ns),
+            static_cast<unsigned long long>(s.hold_max_ns));
+        out += line;
+    }
+    return out;
+}
+
+void reset() { detail::buffers::reset(); }
+
+} // namespace lock_stats
+} // namespace os
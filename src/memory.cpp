@@ -0,0 +1,216 @@
+// memory.cpp
+//
+
+#include "osal/memory.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace os {
+namespace memory {
+
+void deleter::operator()(const void* p) const
+{
+    if (!p)
+        return;
+    switch (m_kind)
+    {
+    case kind::array: delete[] static_cast<const char*>(p); break;
+#ifdef _WIN32
+    case kind::aligned: _aligned_free(const_cast<void*>(p)); break;
+    case kind::mapping: VirtualFree(const_cast<void*>(p), 0, MEM_RELEASE); break;
+#else
+    case kind::aligned: std::free(const_cast<void*>(p)); break;
+    case kind::mapping: munmap(const_cast<void*>(p), m_length); break;
+#endif
+    }
+}
+
+block block::aligned(void* p, std::size_t size)
+{
+    return block(static_cast<char*>(p), size, deleter(deleter::kind::aligned, 0));
+}
+
+block block::mapped(void* p, std::size_t size, std::size_t length)
+{
+    return block(static_cast<char*>(p), size, deleter(deleter::kind::mapping, length));
+}
+
+std::size_t page_size()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    static const std::size_t size = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+#endif
+}
+
+std::size_t huge_page_size()
+{
+    static const std::size_t size = []() -> std::size_t {
+#ifdef __linux__
+        if (auto fd = std::fopen("/proc/meminfo", "r"))
+        {
+            char line[256];
+            std::size_t kb = 0;
+            while (std::fgets(line, sizeof(line), fd))
+            {
+                if (std::sscanf(line, "Hugepagesize: %zu kB", &kb) == 1)
+                    break;
+            }
+            std::fclose(fd);
+            if (kb)
+                return kb << 10;
+        }
+#endif
+        return std::size_t(2) << 20;
+    }();
+    return size;
+}
+
+static std::size_t round_up(std::size_t n, std::size_t to) { return (n + to - 1) / to * to; }
+
+/// Applies prefault and lock to fresh memory, false if locking was refused
+static bool finish(char* p, std::size_t size, unsigned options)
+{
+    if (options & prefault)
+    {
+        auto step = page_size();
+        for (std::size_t i = 0; i < size; i += step)
+            static_cast<volatile char*>(p)[i] = 0;
+    }
+    if (options & lock)
+    {
+#ifdef _WIN32
+        return VirtualLock(p, size) != 0;
+#else
+        return mlock(p, size) == 0;
+#endif
+    }
+    return true;
+}
+
+block alloc_heap(std::size_t size)
+{
+    auto p = new (std::nothrow) char[size];
+    if (!p)
+        return {};
+    return block(p, size, deleter());
+}
+
+block alloc_aligned(std::size_t size, std::size_t alignment, unsigned options)
+{
+    if (size == 0 || alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+        return {};
+#ifdef _WIN32
+    auto p = _aligned_malloc(size, alignment);
+    if (!p)
+        return {};
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, alignment, size) != 0)
+        return {};
+#endif
+    auto b = block::aligned(p, size);
+    if (!finish(b.data(), size, options))
+        return {};
+    return b;
+}
+
+#ifdef __linux__
+/// Anonymous mapping of @p length aligned to @p alignment, trimming the excess
+static char* map_aligned(std::size_t length, std::size_t alignment)
+{
+    auto padded = length + alignment;
+    auto raw    = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+        return nullptr;
+    auto start   = reinterpret_cast<uintptr_t>(raw);
+    auto aligned = (start + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+    if (aligned > start)
+        munmap(raw, aligned - start);
+    auto tail = start + padded - (aligned + length);
+    if (tail)
+        munmap(reinterpret_cast<void*>(aligned + length), tail);
+    return reinterpret_cast<char*>(aligned);
+}
+#endif
+
+block alloc_huge(std::size_t size, unsigned options)
+{
+    if (size == 0)
+        return {};
+#ifdef __linux__
+    auto huge   = huge_page_size();
+    auto length = round_up(size, huge);
+    int flags   = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+    if (options & prefault)
+        flags |= MAP_POPULATE;
+    auto p = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (p == MAP_FAILED)
+    {
+        // No reserved huge pages, let khugepaged back an aligned mapping instead
+        p = map_aligned(length, huge);
+        if (!p)
+            return {};
+        madvise(p, length, MADV_HUGEPAGE);
+    }
+    auto b = block::mapped(p, size, length);
+    if (!finish(b.data(), length, options))
+        return {};
+    return b;
+#else
+    return alloc_aligned(round_up(size, std::size_t(2) << 20), std::size_t(2) << 20, options);
+#endif
+}
+
+block alloc_on_node(std::size_t size, unsigned node, unsigned options)
+{
+    if (size == 0)
+        return {};
+#ifdef __linux__
+    auto length = round_up(size, page_size());
+    auto p      = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED)
+        return {};
+    auto b = block::mapped(p, size, length);
+
+    // mbind from <numaif.h> without depending on libnuma
+    const int mpol_bind = 2;
+    const std::size_t bits = sizeof(unsigned long) * 8;
+    std::unique_ptr<unsigned long[]> mask(new unsigned long[node / bits + 1]());
+    mask[node / bits] |= 1ul << (node % bits);
+    if (syscall(SYS_mbind, p, length, mpol_bind, mask.get(), (node / bits + 1) * bits + 1, 0) != 0)
+    {
+        // Kernels without NUMA support refuse mbind, everything is on node 0 there
+        if (errno != ENOSYS || node != 0)
+            return {};
+    }
+    if (!finish(b.data(), length, options))
+        return {};
+    return b;
+#else
+    if (node != 0)
+        return {};
+    return alloc_aligned(round_up(size, page_size()), page_size(), options);
+#endif
+}
+
+} // namespace memory
+} // namespace os
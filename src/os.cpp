@@ -2,9 +2,18 @@
 //
 
 #include "osal/os.h"
+#include "osal/clock.h"
+#include "osal/extents.h"
+#include "osal/io_metrics.h"
+#include "osal/lock_stats.h"
+#include "osal/park.h"
+#include "osal/trace.h"
 #include "tinydir.h"
+#include <algorithm>
+#include <cerrno>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <fstream>
 #include <sys/stat.h>
@@ -14,7 +23,7 @@
 #include <Synchapi.h> // Sleep
 #else
 #include <pthread.h>
-#include <unistd.h> // usleep
+#include <unistd.h>
 #endif
 
 namespace os {
@@ -97,15 +106,93 @@ void sleep(uint32_t ms)
 #ifdef _WIN32
     Sleep(ms);
 #else
-    usleep(ms * 1000);
+    sleep_for_ns(clock::ms_to_ns(ms));
 #endif
 }
 
+void sleep_for_ns(uint64_t ns)
+{
+    trace::span span("sleep_for_ns", "sleep");
+#ifdef _WIN32
+    sleep_until(clock::deadline_after(clock::monotonic_ns(), ns));
+#else
+    timespec req{};
+    req.tv_sec  = static_cast<time_t>(ns / 1000000000);
+    req.tv_nsec = static_cast<long>(ns % 1000000000);
+    timespec rem{};
+    while (nanosleep(&req, &rem) == -1 && errno == EINTR)
+        req = rem;
+#endif
+}
+
+void sleep_until(uint64_t deadline_ns)
+{
+    trace::span span("sleep_until", "sleep");
+#ifdef _WIN32
+    for (auto now = clock::monotonic_ns(); now < deadline_ns; now = clock::monotonic_ns())
+        Sleep(static_cast<DWORD>((deadline_ns - now + 999999) / 1000000));
+#elif defined(__APPLE__)
+    auto now = clock::monotonic_ns();
+    if (now < deadline_ns)
+        sleep_for_ns(deadline_ns - now);
+#else
+    timespec deadline{};
+    deadline.tv_sec  = static_cast<time_t>(deadline_ns / 1000000000);
+    deadline.tv_nsec = static_cast<long>(deadline_ns % 1000000000);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, nullptr) == EINTR)
+    {
+    }
+#endif
+}
+
+bool sleep(uint32_t ms, thread_synchronizer& sync) { return sleep_for_ns(clock::ms_to_ns(ms), sync); }
+
+bool sleep_for_ns(uint64_t ns, thread_synchronizer& sync)
+{
+    return sleep_until(clock::deadline_after(clock::monotonic_ns(), ns), sync);
+}
+
+bool sleep_until(uint64_t deadline_ns, thread_synchronizer& sync) { return !sync.wait_for_stop_until(deadline_ns); }
+
+static inline void cpu_relax()
+{
+#if OSAL_HAS_TSC
+    _mm_pause();
+#endif
+}
+
+void precise_sleep(uint64_t ns, uint64_t spin_ns)
+{
+    precise_sleep_until(clock::deadline_after(clock::monotonic_ns(), ns), spin_ns);
+}
+
+void precise_sleep_until(uint64_t deadline_ns, uint64_t spin_ns)
+{
+    trace::span span("precise_sleep_until", "sleep");
+    auto now = clock::monotonic_ns();
+    if (deadline_ns > now + spin_ns)
+        sleep_until(deadline_ns - spin_ns);
+
+    while (clock::monotonic_ns() < deadline_ns)
+        cpu_relax();
+}
+
 int time_since_epoch() { return static_cast<int>(std::time(nullptr)); }
 
 recursive_mutex::recursive_mutex()
+    : recursive_mutex(nullptr)
+{}
+
+recursive_mutex::recursive_mutex(const char* name)
     : m_mutex()
+#ifdef OSAL_LOCK_STATS
+    , m_site(lock_stats::detail::register_site(name))
+#endif
+#ifdef OSAL_TRACE
+    , m_name(name ? name : "recursive_mutex")
+#endif
 {
+    (void)name;
 #ifdef _WIN32
     InitializeCriticalSection(&m_mutex);
 #else
@@ -125,6 +212,49 @@ recursive_mutex::~recursive_mutex()
 #endif
 }
 
+#if defined(OSAL_LOCK_STATS) || defined(OSAL_TRACE)
+void recursive_mutex::lock()
+{
+    auto start     = clock::cycles();
+    bool contended = false;
+#ifdef _WIN32
+    if (!TryEnterCriticalSection(&m_mutex))
+    {
+        contended = true;
+        EnterCriticalSection(&m_mutex);
+    }
+#else
+    if (pthread_mutex_trylock(&m_mutex) != 0)
+    {
+        contended = true;
+        pthread_mutex_lock(&m_mutex);
+    }
+#endif
+    auto acquired = clock::cycles();
+#ifdef OSAL_TRACE
+    if (contended)
+        trace::detail::record(m_name, "lock", start, acquired);
+#endif
+#ifdef OSAL_LOCK_STATS
+    lock_stats::detail::record_acquire(m_site, contended, acquired - start);
+    if (m_depth++ == 0)
+        m_acquired_at = acquired;
+#endif
+}
+
+void recursive_mutex::unlock()
+{
+#ifdef OSAL_LOCK_STATS
+    if (--m_depth == 0)
+        lock_stats::detail::record_hold(m_site, clock::cycles() - m_acquired_at);
+#endif
+#ifdef _WIN32
+    LeaveCriticalSection(&m_mutex);
+#else
+    pthread_mutex_unlock(&m_mutex);
+#endif
+}
+#else
 void recursive_mutex::lock()
 {
 #ifdef _WIN32
@@ -142,6 +272,7 @@ void recursive_mutex::unlock()
     pthread_mutex_unlock(&m_mutex);
 #endif
 }
+#endif // OSAL_LOCK_STATS || OSAL_TRACE
 
 recursive_mutex_lock::recursive_mutex_lock(recursive_mutex& mutex)
     : m_locked(false)
@@ -172,7 +303,14 @@ void recursive_mutex_lock::unlock()
     m_locked = false;
 }
 
-temporary_unlock::temporary_unlock(thread_synchronizer& thread_sync) : m_mutex(thread_sync.m_mtx) { m_mutex.unlock(); }
+temporary_unlock::temporary_unlock(thread_synchronizer& thread_sync) : m_mutex(thread_sync.m_mtx)
+{
+#ifdef OSAL_LOCK_STATS
+    lock_stats::detail::record_temporary_unlock(m_mutex.m_site);
+#endif
+    m_mutex.unlock();
+}
+
 temporary_unlock::~temporary_unlock() { m_mutex.lock(); }
 
 recursive_mutex_lock thread_synchronizer::lock()
@@ -193,12 +331,60 @@ void thread_synchronizer::stop()
 {
     recursive_mutex_lock lock(m_mtx);
     m_stop = true;
+    m_stop_epoch.fetch_add(1);
+    detail::unpark_all(m_stop_epoch);
+    for (auto& cb : m_stop_callbacks)
+        cb.second();
+}
+
+bool thread_synchronizer::wait_for_stop_until(uint64_t deadline_ns)
+{
+    trace::span span("wait_for_stop", "sleep");
+    for (;;)
+    {
+        // Read the epoch before checking the flag, a stop() in between changes the epoch and
+        // the park returns immediately
+        auto epoch = m_stop_epoch.load();
+        if (m_stop.load())
+            return true;
+
+        auto now = clock::monotonic_ns();
+        if (now >= deadline_ns)
+            return false;
+        // Capped so a far deadline does not turn into a negative, i.e. unbounded, park
+        detail::park(m_stop_epoch, epoch, static_cast<int64_t>(std::min<uint64_t>(deadline_ns - now, INT64_MAX)));
+    }
+}
+
+std::size_t thread_synchronizer::add_stop_callback(std::function<void()> callback)
+{
+    recursive_mutex_lock lock(m_mtx);
+    auto id = m_next_callback_id++;
+    m_stop_callbacks.emplace_back(id, std::move(callback));
+    return id;
+}
+
+void thread_synchronizer::remove_stop_callback(std::size_t id)
+{
+    recursive_mutex_lock lock(m_mtx);
+    m_stop_callbacks.remove_if([id](const std::pair<std::size_t, std::function<void()>>& cb) { return cb.first == id; });
 }
 
 namespace file {
 
 std::string join(const std::string& dir, const std::string& other) { return dir + separator() + other; }
 
+string_ref join(string_ref dir, string_ref other, arena& a)
+{
+    auto size = dir.size() + 1 + other.size();
+    auto p    = static_cast<char*>(a.allocate(size + 1, 1));
+    std::memcpy(p, dir.data(), dir.size());
+    p[dir.size()] = separator();
+    std::memcpy(p + dir.size() + 1, other.data(), other.size());
+    p[size] = '\0';
+    return string_ref(p, size);
+}
+
 #ifdef _WIN32
 bool win_delete_file(const std::string& path)
 {
@@ -312,17 +498,26 @@ bool unix_delete_dir(const std::string& path)
 }
 #endif
 
+/// is_dir without a metrics scope, for callers that are measured as a whole
+static bool is_dir_unmeasured(const char* path)
+{
+    tinydir_file file{};
+    CharToTChar p(path);
+    return tinydir_file_open(&file, p.to_string()) == 0 && file.is_dir != 0;
+}
+
 bool delete_dir(const std::string& path)
 {
-    if (!is_dir(path))
+    metrics::detail::scope m(metrics::op::delete_dir);
+    if (!is_dir_unmeasured(path.c_str()))
     {
         return true; // success if directory already gone
     }
 
 #ifdef _WIN32
-    return win_delete_dir(win_utf8_to_utf16(path.c_str()));
+    return m.result(win_delete_dir(win_utf8_to_utf16(path.c_str())));
 #else
-    return unix_delete_dir(path);
+    return m.result(unix_delete_dir(path));
 #endif
 }
 
@@ -335,7 +530,8 @@ FILE* win_open(const char* path, const char* mode)
 }
 #endif // _WIN32
 
-FILE* open(const char* path, const char* mode)
+/// open without a metrics scope, for callers that are measured as a whole
+static FILE* open_unmeasured(const char* path, const char* mode)
 {
     // fopen_s doesn't work as you'd expect.
     // If fopen_s is wanted, solve this
@@ -349,6 +545,14 @@ FILE* open(const char* path, const char* mode)
 #endif // _WIN32
 }
 
+FILE* open(const char* path, const char* mode)
+{
+    metrics::detail::scope m(metrics::op::open);
+    auto fd = open_unmeasured(path, mode);
+    m.failed(fd == nullptr);
+    return fd;
+}
+
 FILE* open(const std::string& path, const std::string& mode)
 {
     return open(path.c_str(), mode.c_str());
@@ -370,6 +574,7 @@ bool touch(const char* path)
 
 bool is_reg_file(const char* path)
 {
+    metrics::detail::scope m(metrics::op::is_reg_file);
     tinydir_file file{};
     CharToTChar p(path);
     if (tinydir_file_open(&file, p.to_string()) == 0)
@@ -383,13 +588,8 @@ bool is_reg_file(const std::string& path) { return is_reg_file(path.c_str()); }
 
 bool is_dir(const char* path)
 {
-    tinydir_file file{};
-    CharToTChar p(path);
-    if (tinydir_file_open(&file, p.to_string()) == 0)
-    {
-        return file.is_dir != 0;
-    }
-    return false;
+    metrics::detail::scope m(metrics::op::is_dir);
+    return is_dir_unmeasured(path);
 }
 
 bool is_dir(const std::string& path) { return is_dir(path.c_str()); }
@@ -408,9 +608,14 @@ bool create_dir(const std::string& path, int mode) { return create_dir(path.c_st
 
 bool copy_file(const char* src, const char* dst)
 {
+    metrics::detail::scope m(metrics::op::copy_file);
     std::ifstream in(src, std::ios::binary);
     std::ofstream out(dst, std::ios::binary);
     out << in.rdbuf();
+    auto copied = out.tellp();
+    if (copied > 0)
+        m.bytes(static_cast<uint64_t>(copied));
+    m.failed(!in.is_open() || !out.is_open());
     return true;
 }
 
@@ -428,38 +633,60 @@ size_t win_size(const char* path)
 }
 #endif // _WIN32
 
-size_t size(const char* path)
+/// size without a metrics scope, for callers that are measured as a whole
+/// @return false if @p path cannot be stat'ed, @p out is 0 then
+static bool size_unmeasured(const char* path, size_t& out)
 {
 #ifdef _WIN32
-    return win_size(path);
+    out = win_size(path);
+    return true;
 #else
     struct stat s {};
-    int rc = stat(path, &s);
-    if (rc == 0 && s.st_size <= SIZE_MAX)
-        return static_cast<size_t>(s.st_size);
-    return 0;
+    out = 0;
+    if (stat(path, &s) != 0 || s.st_size > SIZE_MAX)
+        return false;
+    out = static_cast<size_t>(s.st_size);
+    return true;
 #endif
 }
 
-size_t size(const std::string& path)
+size_t size(const char* path)
 {
-    struct stat s {};
-    int rc = stat(path.c_str(), &s);
-    if (rc == 0 && s.st_size <= SIZE_MAX)
-        return static_cast<size_t>(s.st_size);
-    return 0;
+    metrics::detail::scope m(metrics::op::size);
+    size_t s = 0;
+    m.failed(!size_unmeasured(path, s));
+    return s;
 }
 
+size_t size(const std::string& path) { return size(path.c_str()); }
+
 size_t dump(const char* path, const char* data, size_t size, const char* mode)
 {
-    auto fd = os::file::open(path, mode);
+    dump_options options;
+    options.mode = mode;
+    return dump(path, data, size, options);
+}
+
+size_t dump(const char* path, const char* data, size_t size, const dump_options& options)
+{
+    metrics::detail::scope m(metrics::op::dump);
+    // Appends start at the current end, every other mode at the beginning
+    size_t at = 0;
+    if (options.preallocate && std::strchr(options.mode, 'a'))
+        size_unmeasured(path, at);
+    auto fd = open_unmeasured(path, options.mode);
     if (fd)
     {
+        if (options.preallocate)
+            preallocate(fd, at, std::max<uint64_t>(size, options.reserve), true);
         auto s = fwrite(data, 1, size, fd);
         fflush(fd);
         fclose(fd);
+        m.bytes(s);
+        m.failed(s != size);
         return s;
     }
+    m.failed();
     return 0;
 }
 
@@ -473,14 +700,20 @@ size_t dump(const std::string& path, const std::string& data, const char* mode)
     return dump(path.c_str(), data.c_str(), data.size(), mode);
 }
 
-std::list<std::string> list_dir(const char* path)
+size_t dump(const std::string& path, const char* data, size_t size, const dump_options& options)
+{
+    return dump(path.c_str(), data, size, options);
+}
+
+/// Calls @p f with the name of every regular file in @p path, false if it cannot be opened
+template <typename F>
+static bool for_each_reg_file(const char* path, F f)
 {
-    std::list<std::string> l;
     tinydir_dir dir;
     CharToTChar p(path);
     if (tinydir_open(&dir, p.to_string()) == -1)
     {
-        return l;
+        return false;
     }
 
     while (dir.has_next)
@@ -494,7 +727,7 @@ std::list<std::string> list_dir(const char* path)
         if (file.is_reg)
         {
             TCharToChar filename(file.name);
-            l.emplace_back(filename.to_string());
+            f(filename.to_string());
         }
 
         if (tinydir_next(&dir) == -1)
@@ -505,20 +738,34 @@ std::list<std::string> list_dir(const char* path)
 
 bail:
     tinydir_close(&dir);
+    return true;
+}
+
+std::list<std::string> list_dir(const char* path)
+{
+    metrics::detail::scope m(metrics::op::list_dir);
+    std::list<std::string> l;
+    m.failed(!for_each_reg_file(path, [&l](const char* name) { l.emplace_back(name); }));
     return l;
 }
 
 std::list<std::string> list_dir(const std::string& path) { return list_dir(path.c_str()); }
 
-std::string get_stem(const char* path, size_t size)
+arena_vector<string_ref> list_dir(const char* path, arena& a)
 {
-    auto p       = path;
-    size_t start = 0;
-    size_t len   = size;
-    size_t end   = size;
+    metrics::detail::scope m(metrics::op::list_dir);
+    arena_vector<string_ref> l(a);
+    m.failed(!for_each_reg_file(path, [&l, &a](const char* name) { l.push_back(a.copy(name)); }));
+    return l;
+}
 
-    if (end == 0)
-        return std::string();
+/// [start, end) of the stem in @p path
+static void stem_range(const char* path, size_t size, size_t& start, size_t& end)
+{
+    auto p     = path;
+    size_t len = size;
+    start      = 0;
+    end        = size;
 
     for (auto i = len; i != 0; i--)
     {
@@ -538,46 +785,86 @@ std::string get_stem(const char* path, size_t size)
     }
     if (start > end)
         end = len;
+}
+
+std::string get_stem(const char* path, size_t size)
+{
+    if (size == 0)
+        return std::string();
+    size_t start, end;
+    stem_range(path, size, start, end);
     return std::string(path, start, end - start);
 }
 
 std::string get_stem(const std::string& path) { return get_stem(path.c_str(), path.size()); }
 
-std::string get_filename(const char* path, size_t size)
+string_ref get_stem(string_ref path, arena& a)
 {
-    auto p       = path;
-    size_t start = 0;
-
-    if (size == 0)
-        return std::string();
+    size_t start, end;
+    stem_range(path.data(), path.size(), start, end);
+    return a.copy(string_ref(path.data() + start, end - start));
+}
 
+/// Offset of the file name in @p path
+static size_t filename_start(const char* path, size_t size)
+{
     for (auto i = size; i != 0; i--)
     {
-        if (p[i - 1] == '/' || p[i - 1] == '\\')
-        {
-            start = i;
-            break;
-        }
+        if (path[i - 1] == '/' || path[i - 1] == '\\')
+            return i;
     }
+    return 0;
+}
+
+std::string get_filename(const char* path, size_t size)
+{
+    if (size == 0)
+        return std::string();
+    auto start = filename_start(path, size);
     return std::string(path, start, size - start);
 }
 
 std::string get_filename(const std::string& path) { return get_filename(path.c_str(), path.size()); }
 
-ReadData read(const std::string& path)
+string_ref get_filename(string_ref path, arena& a)
 {
-    auto fd = file::open(path.c_str(), "rb");
+    auto start = filename_start(path.data(), path.size());
+    return a.copy(string_ref(path.data() + start, path.size() - start));
+}
+
+BlockReadData read(const std::string& path, const std::function<memory::block(std::size_t)>& allocate)
+{
+    metrics::detail::scope m(metrics::op::read);
+    auto fd = open_unmeasured(path.c_str(), "rb");
     if (!fd)
     {
+        m.failed();
         return {0, nullptr};
     }
 
-    auto size = file::size(path);
-    auto buffer = std::unique_ptr<char[]>(new char[size + 1]);
-    auto bytes_read = fread(buffer.get(), sizeof(char), size, fd);
-    buffer[bytes_read] = '\0';
+    size_t size = 0;
+    size_unmeasured(path.c_str(), size);
+    auto block = allocate(size + 1);
+    if (!block || block.size() < size + 1)
+    {
+        file::close(fd);
+        m.failed();
+        return {0, nullptr};
+    }
+    auto bytes_read = fread(block.data(), sizeof(char), size, fd);
+    block.data()[bytes_read] = '\0';
     file::close(fd);
-    return {bytes_read, std::move(buffer)};
+    m.bytes(bytes_read);
+    auto owned = block.release();
+    auto d = owned.get_deleter();
+    return {bytes_read, std::unique_ptr<const char[], memory::deleter>(owned.release(), d)};
+}
+
+ReadData read(const std::string& path)
+{
+    // alloc_heap memory is new[]'d, so the plain unique_ptr may take it over
+    auto r = read(path, memory::alloc_heap);
+    return {r.num_bytes, std::unique_ptr<const char[]>(r.data.release())};
 }
 
 } // namespace file
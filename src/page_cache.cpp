@@ -0,0 +1,182 @@
+// page_cache.cpp
+//
+
+#include "osal/page_cache.h"
+#include "osal/memory.h"
+#include "fd_guard.h"
+#include <algorithm>
+#include <cerrno>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace os {
+namespace file {
+
+#ifndef _WIN32
+namespace {
+
+using detail::fd_guard;
+
+bool advise_fd(int fd, access hint, extent range)
+{
+#ifdef POSIX_FADV_NORMAL
+    auto offset = static_cast<off_t>(range.offset);
+    auto len    = static_cast<off_t>(range.size);
+    switch (hint)
+    {
+    case access::normal:
+        return posix_fadvise(fd, offset, len, POSIX_FADV_NORMAL) == 0;
+    case access::sequential:
+        return posix_fadvise(fd, offset, len, POSIX_FADV_SEQUENTIAL) == 0;
+    case access::random:
+        return posix_fadvise(fd, offset, len, POSIX_FADV_RANDOM) == 0;
+    case access::noreuse:
+        return posix_fadvise(fd, offset, len, POSIX_FADV_NOREUSE) == 0;
+    case access::willneed:
+#ifdef __linux__
+    {
+        struct stat st;
+        if (len == 0 && ::fstat(fd, &st) == 0)
+            len = std::max<off_t>(st.st_size - offset, 0);
+        if (::readahead(fd, offset, static_cast<std::size_t>(len)) == 0)
+            return true;
+    }
+#endif
+        return posix_fadvise(fd, offset, len, POSIX_FADV_WILLNEED) == 0;
+    case access::dontneed:
+        // Only clean pages are dropped, write the range back first
+#ifdef __linux__
+        if (::sync_file_range(fd, offset, len, SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+                                                   SYNC_FILE_RANGE_WAIT_AFTER) != 0)
+            ::fdatasync(fd);
+#else
+        ::fsync(fd);
+#endif
+        return posix_fadvise(fd, offset, len, POSIX_FADV_DONTNEED) == 0;
+    }
+    return false;
+#else
+    (void)fd;
+    (void)hint;
+    (void)range;
+    return false;
+#endif
+}
+
+} // namespace
+#endif
+
+bool advise(const std::string& path, access hint, extent range)
+{
+#ifdef _WIN32
+    (void)path;
+    (void)hint;
+    (void)range;
+    return false;
+#else
+    fd_guard fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    return fd.get() >= 0 && advise_fd(fd.get(), hint, range);
+#endif
+}
+
+bool advise(FILE* fd, access hint, extent range)
+{
+#ifdef _WIN32
+    (void)fd;
+    (void)hint;
+    (void)range;
+    return false;
+#else
+    // Buffered output would otherwise reach the page cache after the pages were dropped
+    if (!fd || (hint == access::dontneed && fflush(fd) != 0))
+        return false;
+    return advise_fd(fileno(fd), hint, range);
+#endif
+}
+
+bool advise(const void* addr, std::size_t len, access hint)
+{
+#ifdef _WIN32
+    (void)addr;
+    (void)len;
+    (void)hint;
+    return false;
+#else
+    int advice = 0;
+    switch (hint)
+    {
+    case access::normal:
+        advice = MADV_NORMAL;
+        break;
+    case access::sequential:
+        advice = MADV_SEQUENTIAL;
+        break;
+    case access::random:
+        advice = MADV_RANDOM;
+        break;
+    case access::willneed:
+        advice = MADV_WILLNEED;
+        break;
+    case access::dontneed:
+        advice = MADV_DONTNEED;
+        break;
+    case access::noreuse:
+        return false;
+    }
+    auto page  = reinterpret_cast<uintptr_t>(addr) & ~(static_cast<uintptr_t>(memory::page_size()) - 1);
+    auto start = reinterpret_cast<void*>(page);
+    len += reinterpret_cast<uintptr_t>(addr) - page;
+    return madvise(start, len, advice) == 0;
+#endif
+}
+
+bool evict(const std::string& path) { return advise(path, access::dontneed); }
+
+residency_report residency(const std::string& path)
+{
+    residency_report report{0, 0, memory::page_size()};
+#ifndef _WIN32
+    fd_guard fd(::open(path.c_str(), O_RDONLY | O_CLOEXEC));
+    struct stat st;
+    if (fd.get() < 0 || ::fstat(fd.get(), &st) != 0)
+        return report;
+
+    const auto size   = static_cast<uint64_t>(st.st_size);
+    const auto page   = static_cast<uint64_t>(report.page_size);
+    const auto window = std::max<uint64_t>(page, (uint64_t(1) << 30) / page * page);
+#ifdef __APPLE__
+    std::vector<char> pages;
+#else
+    std::vector<unsigned char> pages;
+#endif
+    uint64_t resident = 0;
+    for (uint64_t offset = 0; offset < size; offset += window)
+    {
+        auto len = static_cast<std::size_t>(std::min(window, size - offset));
+        auto p   = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd.get(), static_cast<off_t>(offset));
+        if (p == MAP_FAILED)
+            return report;
+        pages.resize((len + page - 1) / page);
+        bool ok = mincore(p, len, pages.data()) == 0;
+        munmap(p, len);
+        if (!ok)
+            return report;
+        for (auto v : pages)
+            resident += v & 1;
+    }
+    report.resident_pages = resident;
+    report.total_pages    = (size + page - 1) / page;
+#else
+    (void)path;
+#endif
+    return report;
+}
+
+} // namespace file
+} // namespace os
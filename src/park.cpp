@@ -0,0 +1,89 @@
+// park.cpp
+//
+
+#include "osal/park.h"
+#include <cerrno>
+#include <climits>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#endif
+
+namespace os {
+namespace detail {
+
+#ifdef __linux__
+static long futex(const std::atomic<uint32_t>& word, int op, uint32_t val, const timespec* timeout)
+{
+    auto addr = reinterpret_cast<const uint32_t*>(&word);
+    return syscall(SYS_futex, addr, op | FUTEX_PRIVATE_FLAG, val, timeout, nullptr, 0);
+}
+
+bool park(const std::atomic<uint32_t>& word, uint32_t expected, int64_t timeout_ns)
+{
+    timespec ts{};
+    timespec* timeout = nullptr;
+    if (timeout_ns >= 0)
+    {
+        ts.tv_sec  = static_cast<time_t>(timeout_ns / 1000000000);
+        ts.tv_nsec = static_cast<long>(timeout_ns % 1000000000);
+        timeout    = &ts;
+    }
+
+    if (futex(word, FUTEX_WAIT, expected, timeout) == -1)
+        return errno != ETIMEDOUT;
+    return true;
+}
+
+void unpark_one(const std::atomic<uint32_t>& word) { futex(word, FUTEX_WAKE, 1, nullptr); }
+void unpark_all(const std::atomic<uint32_t>& word) { futex(word, FUTEX_WAKE, INT_MAX, nullptr); }
+#else
+/// Waiters hash onto a fixed table of buckets, so unrelated words may share a bucket. Every wake
+/// is a notify_all for that reason; the spurious wake-ups are tolerated by callers.
+struct park_bucket {
+    std::mutex mtx;
+    std::condition_variable cv;
+};
+
+static park_bucket& bucket_for(const std::atomic<uint32_t>& word)
+{
+    static park_bucket buckets[64];
+    auto h = std::hash<const void*>()(&word);
+    return buckets[(h >> 4) % 64];
+}
+
+bool park(const std::atomic<uint32_t>& word, uint32_t expected, int64_t timeout_ns)
+{
+    auto& b = bucket_for(word);
+    std::unique_lock<std::mutex> lock(b.mtx);
+    if (word.load() != expected)
+        return true;
+
+    if (timeout_ns < 0)
+    {
+        b.cv.wait(lock);
+        return true;
+    }
+    return b.cv.wait_for(lock, std::chrono::nanoseconds(timeout_ns)) == std::cv_status::no_timeout;
+}
+
+void unpark_one(const std::atomic<uint32_t>& word) { unpark_all(word); }
+
+void unpark_all(const std::atomic<uint32_t>& word)
+{
+    auto& b = bucket_for(word);
+    std::lock_guard<std::mutex> lock(b.mtx);
+    b.cv.notify_all();
+}
+#endif
+
+} // namespace detail
+} // namespace os
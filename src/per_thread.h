@@ -0,0 +1,79 @@
+// per_thread.h
+//
+
+#ifndef OSAL_PER_THREAD_H
+#define OSAL_PER_THREAD_H
+
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+namespace os {
+namespace detail {
+
+/// @brief One T per thread, plus a registry to aggregate them
+///
+/// local() is lock free after the first call on a thread. When a thread exits its T is merged
+/// into a retired T so nothing it recorded is lost. T needs merge(const T&) and reset(), and
+/// must tolerate being read by for_each() while its owner writes it.
+template <typename T>
+class per_thread {
+public:
+    static T& local()
+    {
+        static thread_local holder h;
+        return h.value;
+    }
+
+    /// @brief Call @p f on the retired T and every live thread's T, under the registry lock
+    template <typename F>
+    static void for_each(F f)
+    {
+        auto& r = get_registry();
+        std::lock_guard<std::mutex> lock(r.mtx);
+        f(r.retired);
+        for (auto t : r.threads)
+            f(*t);
+    }
+
+    static void reset()
+    {
+        for_each([](T& t) { t.reset(); });
+    }
+
+private:
+    struct registry {
+        std::mutex mtx;
+        std::vector<T*> threads;
+        T retired;
+    };
+
+    static registry& get_registry()
+    {
+        static registry* r = new registry(); // never destroyed, threads may outlive static teardown
+        return *r;
+    }
+
+    struct holder {
+        holder()
+        {
+            auto& r = get_registry();
+            std::lock_guard<std::mutex> lock(r.mtx);
+            r.threads.push_back(&value);
+        }
+        ~holder()
+        {
+            auto& r = get_registry();
+            std::lock_guard<std::mutex> lock(r.mtx);
+            r.retired.merge(value);
+            r.threads.erase(std::remove(r.threads.begin(), r.threads.end(), &value), r.threads.end());
+        }
+
+        T value;
+    };
+};
+
+} // namespace detail
+} // namespace os
+
+#endif // OSAL_PER_THREAD_H
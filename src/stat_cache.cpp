@@ -0,0 +1,174 @@
+// stat_cache.cpp
+//
+
+#include "osal/stat_cache.h"
+#include "osal/queue.h"
+#include "osal/watcher.h"
+#include <functional>
+#include <iterator>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+namespace os {
+namespace file {
+
+stat_cache::stat_cache(uint64_t ttl_ns, std::size_t shards)
+    : m_ttl(ttl_ns)
+    , m_mask(detail::round_up_pow2(shards ? shards : 1) - 1)
+    , m_shards(new shard[m_mask + 1])
+{}
+
+// Stops the watcher before the shards it invalidates go away
+stat_cache::~stat_cache() { m_watcher.reset(); }
+
+stat_cache::shard& stat_cache::shard_of(const std::string& path) const
+{
+    return m_shards[std::hash<std::string>()(path) & m_mask];
+}
+
+stat_cache::entry stat_cache::lookup(const std::string& path)
+{
+    auto& s  = shard_of(path);
+    auto now = clock::monotonic_ns();
+    uint64_t generation;
+    {
+        recursive_mutex_lock lock(s.mtx);
+        auto it = s.map.find(path);
+        if (it != s.map.end() && (m_ttl == 0 || now - it->second.stamp_ns < m_ttl))
+        {
+            s.hits++;
+            return it->second;
+        }
+        s.misses++;
+        generation = s.generation;
+    }
+
+    // Same answers as the uncached calls: the type of the link itself, the size of its target
+    entry e{now, 0, false, false, false};
+#ifdef _WIN32
+    e.is_reg = os::file::is_reg_file(path);
+    e.is_dir = os::file::is_dir(path);
+    e.size   = os::file::size(path);
+    e.exists = e.is_reg || e.is_dir;
+#else
+    struct stat st {};
+    if (lstat(path.c_str(), &st) == 0)
+    {
+        e.exists = true;
+        e.is_reg = S_ISREG(st.st_mode);
+        e.is_dir = S_ISDIR(st.st_mode);
+        if (S_ISLNK(st.st_mode) && stat(path.c_str(), &st) != 0)
+            st.st_size = 0;
+        e.size = static_cast<size_t>(st.st_size);
+    }
+#endif
+
+    // An invalidation during the stat may be about this path, so the answer is not kept
+    recursive_mutex_lock lock(s.mtx);
+    if (s.generation == generation)
+        s.map[path] = e;
+    return e;
+}
+
+bool stat_cache::is_reg_file(const std::string& path) { return lookup(path).is_reg; }
+
+bool stat_cache::is_dir(const std::string& path) { return lookup(path).is_dir; }
+
+size_t stat_cache::size(const std::string& path) { return lookup(path).size; }
+
+bool stat_cache::watch(const std::string& dir, bool recursive)
+{
+    recursive_mutex_lock lock(m_watch_mtx);
+    if (!m_watcher)
+    {
+        // No coalescing, an entry should go stale as soon as the kernel says so
+        m_watcher.reset(new watcher(
+            [this](const watch_event& e) {
+                if ((e.changes & rescan) || (e.is_dir && (e.changes & (created | deleted))))
+                    invalidate_below(e.path);
+                else
+                    invalidate(e.path);
+            },
+            0));
+    }
+    if (!m_watcher->add(dir, recursive))
+        return false;
+    invalidate_below(dir); // cached before the watch existed
+    return true;
+}
+
+void stat_cache::invalidate(const std::string& path)
+{
+    auto& s = shard_of(path);
+    recursive_mutex_lock lock(s.mtx);
+    s.map.erase(path);
+    s.generation++;
+}
+
+void stat_cache::invalidate_below(const std::string& path)
+{
+    auto prefix = path;
+    while (prefix.size() > 1 && prefix.back() == '/')
+        prefix.pop_back();
+    for (std::size_t i = 0; i <= m_mask; i++)
+    {
+        auto& s = m_shards[i];
+        recursive_mutex_lock lock(s.mtx);
+        s.generation++;
+        for (auto it = s.map.begin(); it != s.map.end();)
+        {
+            auto& p = it->first;
+            bool below = p.compare(0, prefix.size(), prefix) == 0 &&
+                         (p.size() == prefix.size() || p[prefix.size()] == '/');
+            it = below ? s.map.erase(it) : std::next(it);
+        }
+    }
+}
+
+void stat_cache::clear()
+{
+    for (std::size_t i = 0; i <= m_mask; i++)
+    {
+        recursive_mutex_lock lock(m_shards[i].mtx);
+        m_shards[i].map.clear();
+        m_shards[i].generation++;
+    }
+}
+
+uint64_t stat_cache::hits() const
+{
+    uint64_t n = 0;
+    for (std::size_t i = 0; i <= m_mask; i++)
+    {
+        recursive_mutex_lock lock(m_shards[i].mtx);
+        n += m_shards[i].hits;
+    }
+    return n;
+}
+
+uint64_t stat_cache::misses() const
+{
+    uint64_t n = 0;
+    for (std::size_t i = 0; i <= m_mask; i++)
+    {
+        recursive_mutex_lock lock(m_shards[i].mtx);
+        n += m_shards[i].misses;
+    }
+    return n;
+}
+
+std::size_t stat_cache::entries() const
+{
+    std::size_t n = 0;
+    for (std::size_t i = 0; i <= m_mask; i++)
+    {
+        recursive_mutex_lock lock(m_shards[i].mtx);
+        n += m_shards[i].map.size();
+    }
+    return n;
+}
+
+} // namespace file
+} // namespace os
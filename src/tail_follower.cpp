@@ -0,0 +1,230 @@
+// tail_follower.cpp
+//
+
+#include "osal/tail_follower.h"
+#include "osal/os.h"
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#endif
+
+namespace os {
+namespace file {
+
+static constexpr std::size_t read_chunk = 64 * 1024;
+static constexpr std::size_t max_record = 1024 * 1024;
+
+tail_follower::tail_follower(const std::string& path, callback cb, start_at start, char delimiter)
+    : m_path(path)
+    , m_cb(std::move(cb))
+    , m_delimiter(delimiter)
+{
+#ifdef __linux__
+    m_notify  = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_notify >= 0)
+    {
+        // Creation and renames in the directory reveal rotation and a file that appears later
+        auto slash = path.find_last_of('/');
+        auto dir   = slash == std::string::npos ? std::string(".") : slash == 0 ? std::string("/") : path.substr(0, slash);
+        inotify_add_watch(m_notify, dir.c_str(), IN_CREATE | IN_MOVED_TO | IN_ONLYDIR);
+    }
+#endif
+    // A file that only appears later is new, so all of it is read
+    open_file(start == from_end);
+}
+
+tail_follower::~tail_follower()
+{
+    close_file();
+#ifdef __linux__
+    if (m_notify >= 0)
+        ::close(m_notify);
+    if (m_wake_fd >= 0)
+        ::close(m_wake_fd);
+#endif
+}
+
+bool tail_follower::open_file(bool at_end)
+{
+#ifdef _WIN32
+    (void)at_end;
+    return false;
+#else
+    m_fd = ::open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0)
+        return false;
+    struct stat st {};
+    fstat(m_fd, &st);
+    m_dev    = static_cast<uint64_t>(st.st_dev);
+    m_ino    = static_cast<uint64_t>(st.st_ino);
+    m_offset = 0;
+    m_carry  = 0;
+    if (at_end)
+        m_offset = static_cast<uint64_t>(lseek(m_fd, 0, SEEK_END));
+#ifdef __linux__
+    if (m_notify >= 0)
+        m_file_wd = inotify_add_watch(m_notify, m_path.c_str(), IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF | IN_DELETE_SELF);
+#endif
+    return true;
+#endif
+}
+
+void tail_follower::close_file()
+{
+#ifndef _WIN32
+#ifdef __linux__
+    if (m_file_wd >= 0)
+        inotify_rm_watch(m_notify, m_file_wd);
+    m_file_wd = -1;
+#endif
+    if (m_fd >= 0)
+        ::close(m_fd);
+    m_fd = -1;
+#endif
+}
+
+/// Reads to the end of the file, handing out every complete record
+std::size_t tail_follower::drain()
+{
+    std::size_t records = 0;
+#ifndef _WIN32
+    for (;;)
+    {
+        if (m_buf.size() < m_carry + read_chunk)
+            m_buf.resize(m_carry + read_chunk);
+        auto n = ::read(m_fd, m_buf.data() + m_carry, read_chunk);
+        if (n <= 0)
+            break;
+        m_offset += static_cast<uint64_t>(n);
+
+        // The carried bytes hold no delimiter, scanning starts at the new data
+        auto begin = m_buf.data();
+        auto end   = begin + m_carry + n;
+        auto scan  = begin + m_carry;
+        while (auto hit = static_cast<char*>(std::memchr(scan, m_delimiter, static_cast<std::size_t>(end - scan))))
+        {
+            m_cb(string_ref(begin, static_cast<std::size_t>(hit - begin)));
+            records++;
+            begin = scan = hit + 1;
+        }
+        m_carry = static_cast<std::size_t>(end - begin);
+        if (m_carry >= max_record)
+        {
+            m_cb(string_ref(begin, m_carry));
+            records++;
+            m_carry = 0;
+        }
+        else if (m_carry && begin != m_buf.data())
+        {
+            std::memmove(m_buf.data(), begin, m_carry);
+        }
+    }
+#endif
+    return records;
+}
+
+/// Hands out a trailing record that will never get its delimiter
+std::size_t tail_follower::flush_partial()
+{
+    if (m_carry == 0)
+        return 0;
+    m_cb(string_ref(m_buf.data(), m_carry));
+    m_carry = 0;
+    return 1;
+}
+
+std::size_t tail_follower::poll()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    if (m_fd < 0 && !open_file(false))
+        return 0;
+
+    std::size_t records = 0;
+    struct stat st {};
+    if (fstat(m_fd, &st) == 0 && static_cast<uint64_t>(st.st_size) < m_offset)
+    {
+        // The unfinished record was cut off, it will not be completed in the rewritten file
+        records += flush_partial();
+        lseek(m_fd, 0, SEEK_SET);
+        m_offset = 0;
+        m_truncations++;
+    }
+    records += drain();
+
+    // A different file at the path means rotation, finish the old one first
+    struct stat current {};
+    if (stat(m_path.c_str(), &current) == 0 &&
+        (static_cast<uint64_t>(current.st_dev) != m_dev || static_cast<uint64_t>(current.st_ino) != m_ino))
+    {
+        records += drain();
+        records += flush_partial();
+        close_file();
+        m_rotations++;
+        if (open_file(false))
+            records += drain();
+    }
+    return records;
+#endif
+}
+
+bool tail_follower::wait(int64_t timeout_ns)
+{
+    if (m_stopping)
+        return false;
+#ifdef __linux__
+    if (m_notify >= 0 && m_wake_fd >= 0)
+    {
+        pollfd fds[2] = {{m_notify, POLLIN, 0}, {m_wake_fd, POLLIN, 0}};
+        timespec ts{static_cast<time_t>(timeout_ns / 1000000000), static_cast<long>(timeout_ns % 1000000000)};
+        if (ppoll(fds, 2, timeout_ns < 0 ? nullptr : &ts, nullptr) <= 0 || m_stopping)
+            return false;
+
+        // The events only say that something changed, poll() finds out what
+        char buf[4096];
+        while (::read(m_notify, buf, sizeof(buf)) > 0)
+        {
+        }
+        return true;
+    }
+#endif
+    // Without inotify fall back to polling
+    const uint64_t interval = clock::ms_to_ns(100);
+    sleep_for_ns(timeout_ns < 0 || static_cast<uint64_t>(timeout_ns) > interval ? interval : static_cast<uint64_t>(timeout_ns));
+    return !m_stopping;
+}
+
+void tail_follower::follow()
+{
+    while (!m_stopping)
+    {
+        poll();
+        wait();
+    }
+}
+
+void tail_follower::stop()
+{
+    m_stopping = true;
+#ifdef __linux__
+    if (m_wake_fd >= 0)
+    {
+        uint64_t one = 1;
+        auto rc      = ::write(m_wake_fd, &one, sizeof(one));
+        (void)rc;
+    }
+#endif
+}
+
+} // namespace file
+} // namespace os
@@ -0,0 +1,229 @@
+// text.cpp
+//
+
+#include "osal/text.h"
+#include "osal/cpu_features.h"
+#include <algorithm>
+#include <cstring>
+
+#if OSAL_SIMD_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace os {
+namespace text {
+
+using find_fn = const char* (*)(const char*, const char*, char);
+
+static const char* find_scalar(const char* begin, const char* end, char c)
+{
+    auto hit = begin == end ? nullptr : std::memchr(begin, c, static_cast<std::size_t>(end - begin));
+    return hit ? static_cast<const char*>(hit) : end;
+}
+
+#if OSAL_SIMD_X86
+static unsigned trailing_zeros(uint32_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return index;
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+
+static const char* find_sse2(const char* p, const char* end, char c)
+{
+    const __m128i needle = _mm_set1_epi8(c);
+    while (end - p >= 16)
+    {
+        auto v    = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, needle)));
+        if (mask)
+            return p + trailing_zeros(mask);
+        p += 16;
+    }
+    for (; p < end; p++)
+    {
+        if (*p == c)
+            return p;
+    }
+    return end;
+}
+
+// Two vectors per step keeps enough loads in flight to reach memory bandwidth
+OSAL_TARGET("avx2") static const char* find_avx2(const char* p, const char* end, char c)
+{
+    const __m256i needle = _mm256_set1_epi8(c);
+    while (end - p >= 64)
+    {
+        auto a = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), needle);
+        auto b = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)), needle);
+        if (!_mm256_testz_si256(_mm256_or_si256(a, b), _mm256_or_si256(a, b)))
+        {
+            auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(a));
+            if (mask)
+                return p + trailing_zeros(mask);
+            return p + 32 + trailing_zeros(static_cast<uint32_t>(_mm256_movemask_epi8(b)));
+        }
+        p += 64;
+    }
+    if (end - p >= 32)
+    {
+        auto mask = static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), needle)));
+        if (mask)
+            return p + trailing_zeros(mask);
+        p += 32;
+    }
+    return find_sse2(p, end, c);
+}
+#endif
+
+const char* find_byte(const char* begin, const char* end, char c)
+{
+    static const dispatch<find_fn> kernels{
+        {simd_tier::scalar, find_scalar},
+#if OSAL_SIMD_X86
+        {simd_tier::sse2, find_sse2},
+        {simd_tier::avx2, find_avx2},
+#endif
+    };
+    return kernels.get()(begin, end, c);
+}
+
+bool line_splitter::next(string_ref& record)
+{
+    if (m_carry_done)
+    {
+        m_carry.clear();
+        m_carry_done = false;
+    }
+    auto hit = m_end;
+    for (;;)
+    {
+        if (m_pos == m_end)
+            return false;
+        hit = find_byte(m_pos, m_end, m_delimiter);
+        auto size = m_carry.size() + static_cast<std::size_t>(hit - m_pos);
+        if (!m_skip && size <= m_max)
+            break;
+        if (!m_skip)
+            m_oversized++;
+        // Drop the oversized record up to its delimiter, or all of the chunk if it goes on
+        m_carry.clear();
+        m_skip = hit == m_end;
+        m_pos  = hit == m_end ? hit : hit + 1;
+    }
+
+    if (hit == m_end)
+    {
+        m_carry.append(m_pos, m_end);
+        m_pos = m_end;
+        return false;
+    }
+    if (m_carry.empty())
+    {
+        record = string_ref(m_pos, static_cast<std::size_t>(hit - m_pos));
+    }
+    else
+    {
+        m_carry.append(m_pos, hit);
+        record       = string_ref(m_carry);
+        m_carry_done = true;
+    }
+    m_pos = hit + 1;
+    return true;
+}
+
+bool line_splitter::finish(string_ref& record)
+{
+    if (m_carry_done)
+    {
+        m_carry.clear();
+        m_carry_done = false;
+    }
+    m_skip = false;
+    if (m_carry.empty())
+        return false;
+    record       = string_ref(m_carry);
+    m_carry_done = true;
+    return true;
+}
+
+uint64_t record_splitter::length(const char* p) const
+{
+    uint64_t n = 0;
+    for (std::size_t i = 0; i < m_prefix; i++)
+    {
+        auto byte = static_cast<uint64_t>(static_cast<unsigned char>(p[m_big_endian ? i : m_prefix - 1 - i]));
+        n         = (n << 8) | byte;
+    }
+    return n;
+}
+
+bool record_splitter::overflow()
+{
+    m_overflow = true;
+    m_carry.clear();
+    m_pos = m_end;
+    return false;
+}
+
+bool record_splitter::next(string_ref& record)
+{
+    if (m_carry_done)
+    {
+        m_carry.clear();
+        m_carry_done = false;
+    }
+    auto avail = static_cast<std::size_t>(m_end - m_pos);
+    if (avail == 0 || m_overflow)
+        return false;
+
+    if (!m_carry.empty())
+    {
+        // Complete the prefix first, then the body it announces
+        if (m_carry.size() < m_prefix)
+        {
+            auto take = std::min(m_prefix - m_carry.size(), avail);
+            m_carry.append(m_pos, take);
+            m_pos += take;
+            avail -= take;
+            if (m_carry.size() < m_prefix)
+                return false;
+        }
+        auto body = length(m_carry.data());
+        if (body > m_max)
+            return overflow();
+        auto total = m_prefix + static_cast<std::size_t>(body);
+        auto take  = std::min(total - m_carry.size(), avail);
+        m_carry.append(m_pos, take);
+        m_pos += take;
+        if (m_carry.size() < total)
+            return false;
+        record       = string_ref(m_carry.data() + m_prefix, m_carry.size() - m_prefix);
+        m_carry_done = true;
+        return true;
+    }
+
+    if (avail >= m_prefix && length(m_pos) > m_max)
+        return overflow();
+    if (avail < m_prefix || length(m_pos) > avail - m_prefix)
+    {
+        m_carry.append(m_pos, avail);
+        m_pos = m_end;
+        return false;
+    }
+    auto size = static_cast<std::size_t>(length(m_pos));
+    record    = string_ref(m_pos + m_prefix, size);
+    m_pos += m_prefix + size;
+    return true;
+}
+
+} // namespace text
+} // namespace os
@@ -0,0 +1,305 @@
+// thread.cpp
+//
+
+#include "osal/thread.h"
+#include "cpu_list.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace os {
+
+#ifdef _WIN32
+static std::vector<unsigned> mask_to_cpus(DWORD_PTR mask)
+{
+    std::vector<unsigned> cpus;
+    for (unsigned c = 0; c < sizeof(mask) * 8; c++)
+    {
+        if (mask & (static_cast<DWORD_PTR>(1) << c))
+            cpus.push_back(c);
+    }
+    return cpus;
+}
+#endif
+
+unsigned cpu_count()
+{
+#ifdef _WIN32
+    DWORD_PTR process = 0, system = 0;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &process, &system) && process)
+        return static_cast<unsigned>(mask_to_cpus(process).size());
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0 && CPU_COUNT(&set) > 0)
+        return static_cast<unsigned>(CPU_COUNT(&set));
+#endif
+    return std::max(1u, std::thread::hardware_concurrency());
+}
+
+std::vector<unsigned> online_cpus()
+{
+#ifdef __linux__
+    auto cpus = detail::parse_cpu_list(detail::read_line("/sys/devices/system/cpu/online").c_str());
+    if (!cpus.empty())
+        return cpus;
+#endif
+
+#ifdef _WIN32
+    auto n = static_cast<unsigned>(GetActiveProcessorCount(ALL_PROCESSOR_GROUPS));
+#else
+    auto online = sysconf(_SC_NPROCESSORS_ONLN);
+    auto n      = online > 0 ? static_cast<unsigned>(online) : 1u;
+#endif
+    std::vector<unsigned> all;
+    for (unsigned c = 0; c < n; c++)
+        all.push_back(c);
+    return all;
+}
+
+namespace this_thread {
+
+bool set_affinity(const std::vector<unsigned>& cpus)
+{
+    if (cpus.empty())
+        return false;
+#ifdef _WIN32
+    DWORD_PTR mask = 0;
+    for (auto c : cpus)
+    {
+        if (c >= sizeof(mask) * 8)
+            return false;
+        mask |= static_cast<DWORD_PTR>(1) << c;
+    }
+    return SetThreadAffinityMask(GetCurrentThread(), mask) != 0;
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto c : cpus)
+    {
+        if (c >= CPU_SETSIZE)
+            return false;
+        CPU_SET(c, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false; // macOS only offers affinity hints
+#endif
+}
+
+std::vector<unsigned> affinity()
+{
+#ifdef _WIN32
+    DWORD_PTR process = 0, system = 0;
+    GetProcessAffinityMask(GetCurrentProcess(), &process, &system);
+    // There is no getter, setting returns the previous mask which is then put back
+    auto previous = SetThreadAffinityMask(GetCurrentThread(), process);
+    if (previous)
+    {
+        SetThreadAffinityMask(GetCurrentThread(), previous);
+        return mask_to_cpus(previous);
+    }
+    return mask_to_cpus(process);
+#elif defined(__linux__)
+    std::vector<unsigned> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) == 0)
+    {
+        for (unsigned c = 0; c < CPU_SETSIZE; c++)
+        {
+            if (CPU_ISSET(c, &set))
+                cpus.push_back(c);
+        }
+    }
+    return cpus;
+#else
+    return online_cpus();
+#endif
+}
+
+bool pin(unsigned cpu) { return set_affinity({cpu}); }
+
+#ifdef _WIN32
+static thread_local std::string t_name;
+#endif
+
+bool set_name(const char* name)
+{
+    if (!name)
+        return false;
+#ifdef _WIN32
+    int len = MultiByteToWideChar(CP_UTF8, 0, name, -1, NULL, 0);
+    if (len < 1)
+        return false;
+    std::vector<wchar_t> wide(len, 0);
+    MultiByteToWideChar(CP_UTF8, 0, name, -1, wide.data(), len);
+    if (FAILED(SetThreadDescription(GetCurrentThread(), wide.data())))
+        return false;
+    t_name = name;
+    return true;
+#elif defined(__APPLE__)
+    return pthread_setname_np(name) == 0;
+#else
+    // The kernel keeps 15 characters and rejects longer names
+    char truncated[16];
+    std::strncpy(truncated, name, sizeof(truncated) - 1);
+    truncated[sizeof(truncated) - 1] = '\0';
+    return pthread_setname_np(pthread_self(), truncated) == 0;
+#endif
+}
+
+std::string name()
+{
+#ifdef _WIN32
+    return t_name;
+#else
+    char buf[64] = {};
+    if (pthread_getname_np(pthread_self(), buf, sizeof(buf)) != 0)
+        return {};
+    return buf;
+#endif
+}
+
+#ifdef _WIN32
+bool set_scheduling(sched_policy policy, int priority)
+{
+    (void)priority;
+    int p = THREAD_PRIORITY_NORMAL;
+    switch (policy)
+    {
+    case sched_policy::other: p = THREAD_PRIORITY_NORMAL; break;
+    case sched_policy::batch: p = THREAD_PRIORITY_BELOW_NORMAL; break;
+    case sched_policy::idle: p = THREAD_PRIORITY_IDLE; break;
+    case sched_policy::fifo:
+    case sched_policy::round_robin: p = THREAD_PRIORITY_TIME_CRITICAL; break;
+    }
+    return SetThreadPriority(GetCurrentThread(), p) != 0;
+}
+
+sched_policy scheduling_policy()
+{
+    switch (GetThreadPriority(GetCurrentThread()))
+    {
+    case THREAD_PRIORITY_TIME_CRITICAL: return sched_policy::fifo;
+    case THREAD_PRIORITY_IDLE: return sched_policy::idle;
+    case THREAD_PRIORITY_BELOW_NORMAL:
+    case THREAD_PRIORITY_LOWEST: return sched_policy::batch;
+    default: return sched_policy::other;
+    }
+}
+
+int scheduling_priority() { return 0; }
+
+bool set_nice(int nice)
+{
+    int p = THREAD_PRIORITY_NORMAL;
+    if (nice <= -15)
+        p = THREAD_PRIORITY_HIGHEST;
+    else if (nice < 0)
+        p = THREAD_PRIORITY_ABOVE_NORMAL;
+    else if (nice >= 15)
+        p = THREAD_PRIORITY_LOWEST;
+    else if (nice > 0)
+        p = THREAD_PRIORITY_BELOW_NORMAL;
+    return SetThreadPriority(GetCurrentThread(), p) != 0;
+}
+
+int nice()
+{
+    switch (GetThreadPriority(GetCurrentThread()))
+    {
+    case THREAD_PRIORITY_HIGHEST: return -15;
+    case THREAD_PRIORITY_ABOVE_NORMAL: return -5;
+    case THREAD_PRIORITY_BELOW_NORMAL: return 5;
+    case THREAD_PRIORITY_LOWEST: return 15;
+    default: return 0;
+    }
+}
+#else
+static int to_native(sched_policy policy)
+{
+    switch (policy)
+    {
+#ifdef __linux__
+    case sched_policy::batch: return SCHED_BATCH;
+    case sched_policy::idle: return SCHED_IDLE;
+#endif
+    case sched_policy::fifo: return SCHED_FIFO;
+    case sched_policy::round_robin: return SCHED_RR;
+    case sched_policy::other: return SCHED_OTHER;
+    default: return -1;
+    }
+}
+
+bool set_scheduling(sched_policy policy, int priority)
+{
+    auto native = to_native(policy);
+    if (native == -1)
+        return false;
+    sched_param param{};
+    param.sched_priority = (native == SCHED_FIFO || native == SCHED_RR) ? priority : 0;
+    return pthread_setschedparam(pthread_self(), native, &param) == 0;
+}
+
+sched_policy scheduling_policy()
+{
+    int native = SCHED_OTHER;
+    sched_param param{};
+    pthread_getschedparam(pthread_self(), &native, &param);
+    switch (native)
+    {
+#ifdef __linux__
+    case SCHED_BATCH: return sched_policy::batch;
+    case SCHED_IDLE: return sched_policy::idle;
+#endif
+    case SCHED_FIFO: return sched_policy::fifo;
+    case SCHED_RR: return sched_policy::round_robin;
+    default: return sched_policy::other;
+    }
+}
+
+int scheduling_priority()
+{
+    int native = SCHED_OTHER;
+    sched_param param{};
+    if (pthread_getschedparam(pthread_self(), &native, &param) != 0)
+        return 0;
+    return param.sched_priority;
+}
+
+static id_t nice_target()
+{
+#ifdef __linux__
+    // Linux applies PRIO_PROCESS to a single thread when given its tid
+    return static_cast<id_t>(syscall(SYS_gettid));
+#else
+    return 0;
+#endif
+}
+
+bool set_nice(int nice) { return setpriority(PRIO_PROCESS, nice_target(), nice) == 0; }
+
+int nice()
+{
+    errno = 0;
+    auto n = getpriority(PRIO_PROCESS, nice_target());
+    return errno == 0 ? n : 0;
+}
+#endif // _WIN32
+
+} // namespace this_thread
+} // namespace os
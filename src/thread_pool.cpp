@@ -0,0 +1,273 @@
+// thread_pool.cpp
+//
+
+#include "osal/thread_pool.h"
+#include "osal/trace.h"
+
+namespace os {
+
+/// Chase-Lev work-stealing deque (Lê, Pop, Cohen, Zappa Nardelli, "Correct and Efficient
+/// Work-Stealing for Weak Memory Models"). The owner pushes and pops at the bottom, thieves
+/// steal from the top. Retired rings are kept until the deque dies since a thief may still be
+/// reading one.
+class work_deque {
+    using task = thread_pool::task;
+
+    struct ring {
+        explicit ring(std::size_t capacity)
+            : mask(capacity - 1)
+            , slots(new std::atomic<task*>[capacity])
+        {}
+
+        task* get(int64_t i) const { return slots[static_cast<std::size_t>(i) & mask].load(std::memory_order_relaxed); }
+        void put(int64_t i, task* t) { slots[static_cast<std::size_t>(i) & mask].store(t, std::memory_order_relaxed); }
+        std::size_t capacity() const { return mask + 1; }
+
+        std::size_t mask;
+        std::unique_ptr<std::atomic<task*>[]> slots;
+    };
+
+public:
+    work_deque()
+    {
+        m_rings.emplace_back(new ring(256));
+        m_ring.store(m_rings.back().get(), std::memory_order_relaxed);
+    }
+
+    void push(task* t)
+    {
+        auto b = m_bottom.load(std::memory_order_relaxed);
+        auto top = m_top.load(std::memory_order_acquire);
+        auto r = m_ring.load(std::memory_order_relaxed);
+        if (b - top > static_cast<int64_t>(r->mask))
+            r = grow(r, top, b);
+        r->put(b, t);
+        m_bottom.store(b + 1, std::memory_order_release);
+    }
+
+    task* pop()
+    {
+        auto b = m_bottom.load(std::memory_order_relaxed) - 1;
+        auto r = m_ring.load(std::memory_order_relaxed);
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto top = m_top.load(std::memory_order_relaxed);
+
+        if (top > b)
+        {
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        auto t = r->get(b);
+        if (top == b)
+        {
+            // Last element, race against thieves for it
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                t = nullptr;
+            m_bottom.store(b + 1, std::memory_order_relaxed);
+        }
+        return t;
+    }
+
+    task* steal()
+    {
+        auto top = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto b = m_bottom.load(std::memory_order_acquire);
+        if (top >= b)
+            return nullptr;
+
+        auto r = m_ring.load(std::memory_order_acquire);
+        auto t = r->get(top);
+        if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return t;
+    }
+
+private:
+    ring* grow(ring* r, int64_t top, int64_t bottom)
+    {
+        m_rings.emplace_back(new ring(r->capacity() * 2));
+        auto bigger = m_rings.back().get();
+        for (auto i = top; i < bottom; i++)
+            bigger->put(i, r->get(i));
+        m_ring.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+
+    alignas(64) std::atomic<int64_t> m_top{0};
+    alignas(64) std::atomic<int64_t> m_bottom{0};
+    std::atomic<ring*> m_ring{nullptr};
+    std::vector<std::unique_ptr<ring>> m_rings; // owner only
+};
+
+struct thread_pool::worker {
+    work_deque deque;
+    uint64_t rng;
+};
+
+/// Pool and index of the worker running on this thread, used to route submissions made from
+/// inside a task onto the worker's own deque.
+static thread_local thread_pool* t_pool = nullptr;
+static thread_local std::size_t t_index = 0;
+
+thread_pool::thread_pool(std::size_t num_threads) { start(num_threads); }
+
+thread_pool::thread_pool(thread_synchronizer& sync, std::size_t num_threads)
+    : m_sync(&sync)
+{
+    m_sync_callback = sync.add_stop_callback([this]() { begin_stop(); });
+    start(num_threads);
+    if (sync.stopped())
+        begin_stop();
+}
+
+thread_pool::~thread_pool()
+{
+    if (m_sync)
+        m_sync->remove_stop_callback(m_sync_callback);
+    shutdown();
+}
+
+void thread_pool::start(std::size_t num_threads)
+{
+    if (num_threads == 0)
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (std::size_t i = 0; i < num_threads; i++)
+    {
+        m_workers.push_back(memory::make_aligned<worker>());
+        m_workers.back()->rng = 0x9e3779b97f4a7c15ull * (i + 1);
+    }
+    for (std::size_t i = 0; i < num_threads; i++)
+        m_threads.emplace_back(&thread_pool::run, this, i);
+}
+
+void thread_pool::begin_stop()
+{
+    {
+        recursive_mutex_lock lock(m_inject_mtx);
+        m_stopping = true;
+    }
+    m_epoch.fetch_add(1);
+    detail::unpark_all(m_epoch);
+}
+
+void thread_pool::shutdown()
+{
+    begin_stop();
+    for (auto& t : m_threads)
+    {
+        if (t.joinable())
+            t.join();
+    }
+}
+
+bool thread_pool::post(task t)
+{
+    auto p = new task(std::move(t));
+    if (t_pool == this)
+    {
+        // Tasks queued by a running task are drained by its worker before it exits
+        m_workers[t_index]->deque.push(p);
+    }
+    else
+    {
+        recursive_mutex_lock lock(m_inject_mtx);
+        if (m_stopping)
+        {
+            delete p;
+            return false;
+        }
+        m_inject.push_back(p);
+        m_inject_size++;
+    }
+    notify();
+    return true;
+}
+
+void thread_pool::notify()
+{
+    m_epoch.fetch_add(1);
+    if (m_idle.load() != 0)
+        detail::unpark_one(m_epoch);
+}
+
+thread_pool::task* thread_pool::find_task(std::size_t index)
+{
+    auto& self = *m_workers[index];
+    if (auto t = self.deque.pop())
+        return t;
+
+    if (m_inject_size.load(std::memory_order_relaxed) != 0)
+    {
+        recursive_mutex_lock lock(m_inject_mtx);
+        if (!m_inject.empty())
+        {
+            auto t = m_inject.front();
+            m_inject.pop_front();
+            m_inject_size--;
+            return t;
+        }
+    }
+
+    // xorshift to pick where to start stealing, so thieves spread over their victims
+    self.rng ^= self.rng << 13;
+    self.rng ^= self.rng >> 7;
+    self.rng ^= self.rng << 17;
+    auto n = m_workers.size();
+    auto start = static_cast<std::size_t>(self.rng % n);
+    for (std::size_t i = 0; i < n; i++)
+    {
+        auto victim = (start + i) % n;
+        if (victim == index)
+            continue;
+        if (auto t = m_workers[victim]->deque.steal())
+            return t;
+    }
+    return nullptr;
+}
+
+bool thread_pool::run_one(std::size_t index)
+{
+    auto t = find_task(index);
+    if (!t)
+        return false;
+
+    std::unique_ptr<task> owned(t);
+    trace::span span("task", "thread_pool");
+    (*owned)();
+    return true;
+}
+
+void thread_pool::run(std::size_t index)
+{
+    t_pool  = this;
+    t_index = index;
+
+    for (;;)
+    {
+        if (run_one(index))
+            continue;
+
+        // Read the epoch before the final check so a post() racing with us changes it and the
+        // park below returns immediately. The stop flag is read before it too: post() only
+        // queues while the flag is clear, so once it is seen set an empty check means the
+        // queues are drained for good.
+        auto epoch    = m_epoch.load();
+        auto stopping = m_stopping.load();
+        if (run_one(index))
+            continue;
+        if (stopping)
+            break;
+
+        m_idle.fetch_add(1);
+        detail::park(m_epoch, epoch);
+        m_idle.fetch_sub(1);
+    }
+
+    t_pool = nullptr;
+}
+
+} // namespace os
@@ -0,0 +1,315 @@
+// timer_service.cpp
+//
+
+#include "osal/timer_service.h"
+#include "osal/park.h"
+#include "osal/thread_pool.h"
+#include "osal/trace.h"
+
+namespace os {
+
+static constexpr uint32_t none = UINT32_MAX;
+
+// Level 0 has 256 one-tick slots, levels 1-3 have 64 slots each covering 64x the span of a
+// slot one level down. The wheel spans 2^26 ticks, timers further out are parked in the last
+// level and re-cascaded until they come into range.
+static constexpr uint64_t l0_bits = 8;
+static constexpr uint64_t ln_bits = 6;
+static constexpr uint64_t l0_size = 1 << l0_bits;
+static constexpr uint64_t ln_size = 1 << ln_bits;
+static constexpr uint64_t levels  = 4;
+static constexpr uint64_t span    = 1ull << (l0_bits + (levels - 1) * ln_bits);
+
+static uint64_t level_shift(uint64_t level) { return level == 0 ? 0 : l0_bits + (level - 1) * ln_bits; }
+static uint64_t level_offset(uint64_t level) { return level == 0 ? 0 : l0_size + (level - 1) * ln_size; }
+
+timer_service::timer_service(uint64_t resolution_ns)
+    : m_resolution(resolution_ns == 0 ? 1 : resolution_ns)
+    , m_start(clock::monotonic_ns())
+    , m_slots(l0_size + (levels - 1) * ln_size, none)
+{
+    m_thread = std::thread(&timer_service::run, this);
+}
+
+timer_service::timer_service(thread_pool& pool, uint64_t resolution_ns)
+    : m_resolution(resolution_ns == 0 ? 1 : resolution_ns)
+    , m_start(clock::monotonic_ns())
+    , m_pool(&pool)
+    , m_slots(l0_size + (levels - 1) * ln_size, none)
+{
+    m_thread = std::thread(&timer_service::run, this);
+}
+
+timer_service::~timer_service() { stop(); }
+
+void timer_service::stop()
+{
+    m_stopping = true;
+    m_wake.fetch_add(1);
+    detail::unpark_all(m_wake);
+    if (m_thread.joinable() && m_thread.get_id() != std::this_thread::get_id())
+        m_thread.join();
+}
+
+uint64_t timer_service::current_tick() const { return (clock::monotonic_ns() - m_start) / m_resolution; }
+
+uint64_t timer_service::to_tick(uint64_t deadline_ns) const
+{
+    if (deadline_ns <= m_start)
+        return 0;
+    return (deadline_ns - m_start + m_resolution - 1) / m_resolution;
+}
+
+timer_service::timer_id timer_service::schedule(uint64_t delay_ns, callback cb)
+{
+    return add(clock::monotonic_ns() + delay_ns, 0, std::move(cb));
+}
+
+timer_service::timer_id timer_service::schedule_at(uint64_t deadline_ns, callback cb)
+{
+    return add(deadline_ns, 0, std::move(cb));
+}
+
+timer_service::timer_id timer_service::schedule_periodic(uint64_t period_ns, callback cb)
+{
+    if (period_ns == 0)
+        period_ns = m_resolution;
+    return add(clock::monotonic_ns() + period_ns, period_ns, std::move(cb));
+}
+
+timer_service::timer_id timer_service::add(uint64_t deadline_ns, uint64_t period_ns, callback cb)
+{
+    bool wake = false;
+    timer_id id;
+    {
+        recursive_mutex_lock lock(m_mtx);
+        if (m_count == 0)
+        {
+            // Nothing was pending so the service thread may not have ticked in a while
+            auto now = current_tick();
+            if (now > m_tick)
+                m_tick = now;
+        }
+
+        auto index = allocate();
+        auto& n    = m_nodes[index];
+        n.deadline = deadline_ns;
+        n.period   = period_ns;
+        n.tick     = to_tick(deadline_ns);
+        n.cb       = std::make_shared<callback>(std::move(cb));
+        insert(index);
+        m_count++;
+
+        id   = (static_cast<uint64_t>(n.generation) << 32) | (index + 1);
+        wake = n.tick < m_wake_tick;
+        if (wake)
+            m_wake_tick = n.tick;
+    }
+
+    if (wake)
+    {
+        m_wake.fetch_add(1);
+        detail::unpark_one(m_wake);
+    }
+    return id;
+}
+
+bool timer_service::cancel(timer_id id)
+{
+    auto index      = static_cast<uint32_t>(id & 0xffffffff) - 1;
+    auto generation = static_cast<uint32_t>(id >> 32);
+
+    recursive_mutex_lock lock(m_mtx);
+    if (id == 0 || index >= m_nodes.size())
+        return false;
+    auto& n = m_nodes[index];
+    if (n.generation != generation || n.slot == none)
+        return false;
+
+    unlink(index);
+    release(index);
+    m_count--;
+    return true;
+}
+
+uint32_t timer_service::allocate()
+{
+    if (m_free != none)
+    {
+        auto index = m_free;
+        m_free     = m_nodes[index].next;
+        return index;
+    }
+    m_nodes.push_back(node{0, 0, 0, nullptr, none, none, none, 0});
+    return static_cast<uint32_t>(m_nodes.size() - 1);
+}
+
+void timer_service::release(uint32_t index)
+{
+    auto& n = m_nodes[index];
+    n.cb.reset();
+    n.generation++;
+    n.slot = none;
+    n.prev = none;
+    n.next = m_free;
+    m_free = index;
+}
+
+void timer_service::insert(uint32_t index)
+{
+    auto& n = m_nodes[index];
+    auto expires = n.tick <= m_tick ? m_tick + 1 : n.tick;
+    auto delta   = expires - m_tick;
+    if (delta >= span)
+        expires = m_tick + span - 1;
+
+    uint64_t level = 0;
+    while (level + 1 < levels && delta >= (1ull << level_shift(level + 1)))
+        level++;
+    auto mask = (level == 0 ? l0_size : ln_size) - 1;
+    auto slot = static_cast<uint32_t>(level_offset(level) + ((expires >> level_shift(level)) & mask));
+
+    n.slot = slot;
+    n.prev = none;
+    n.next = m_slots[slot];
+    if (n.next != none)
+        m_nodes[n.next].prev = index;
+    m_slots[slot] = index;
+}
+
+void timer_service::unlink(uint32_t index)
+{
+    auto& n = m_nodes[index];
+    if (n.prev != none)
+        m_nodes[n.prev].next = n.next;
+    else
+        m_slots[n.slot] = n.next;
+    if (n.next != none)
+        m_nodes[n.next].prev = n.prev;
+    n.slot = none;
+}
+
+void timer_service::advance(std::vector<std::shared_ptr<callback>>& expired)
+{
+    m_tick++;
+
+    // Cascade the higher level slots whose span starts at this tick
+    for (uint64_t level = 1; level < levels; level++)
+    {
+        auto shift = level_shift(level);
+        if ((m_tick & ((1ull << shift) - 1)) != 0)
+            break;
+
+        auto slot = static_cast<uint32_t>(level_offset(level) + ((m_tick >> shift) & (ln_size - 1)));
+        auto i    = m_slots[slot];
+        m_slots[slot] = none;
+        while (i != none)
+        {
+            auto next = m_nodes[i].next;
+            insert(i);
+            i = next;
+        }
+    }
+
+    auto slot = static_cast<uint32_t>(m_tick & (l0_size - 1));
+    auto i    = m_slots[slot];
+    m_slots[slot] = none;
+    while (i != none)
+    {
+        auto next = m_nodes[i].next;
+        auto& n   = m_nodes[i];
+        n.slot    = none;
+        if (n.tick > m_tick)
+        {
+            insert(i);
+        }
+        else if (n.period != 0)
+        {
+            // Skip whole periods that were missed instead of firing back to back
+            expired.push_back(n.cb);
+            do
+            {
+                n.deadline += n.period;
+                n.tick = to_tick(n.deadline);
+            } while (n.tick <= m_tick);
+            insert(i);
+        }
+        else
+        {
+            expired.push_back(std::move(n.cb));
+            release(i);
+            m_count--;
+        }
+        i = next;
+    }
+}
+
+uint64_t timer_service::next_wakeup_tick() const
+{
+    if (m_count == 0)
+        return UINT64_MAX;
+
+    // The next occupied level 0 slot, or the next cascade point at the latest
+    for (auto t = m_tick + 1;; t++)
+    {
+        if ((t & (l0_size - 1)) == 0 || m_slots[t & (l0_size - 1)] != none)
+            return t;
+    }
+}
+
+void timer_service::dispatch(std::vector<std::shared_ptr<callback>>& expired)
+{
+    for (auto& cb : expired)
+    {
+        if (m_pool)
+        {
+            std::shared_ptr<callback> job(std::move(cb));
+            if (m_pool->post([job]() { (*job)(); }))
+                continue;
+            cb = std::move(job);
+        }
+        trace::span span("timer", "timer_service");
+        (*cb)();
+    }
+    expired.clear();
+}
+
+void timer_service::run()
+{
+    std::vector<std::shared_ptr<callback>> expired;
+    while (!m_stopping)
+    {
+        uint32_t epoch;
+        uint64_t wake_tick;
+        {
+            recursive_mutex_lock lock(m_mtx);
+            epoch    = m_wake.load();
+            auto now = current_tick();
+            while (m_tick < now)
+            {
+                if (m_count == 0)
+                {
+                    m_tick = now;
+                    break;
+                }
+                advance(expired);
+            }
+            wake_tick   = next_wakeup_tick();
+            m_wake_tick = wake_tick;
+        }
+
+        dispatch(expired);
+
+        if (wake_tick == UINT64_MAX)
+        {
+            detail::park(m_wake, epoch);
+            continue;
+        }
+        auto deadline = m_start + wake_tick * m_resolution;
+        auto now      = clock::monotonic_ns();
+        if (deadline > now)
+            detail::park(m_wake, epoch, static_cast<int64_t>(deadline - now));
+    }
+}
+
+} // namespace os
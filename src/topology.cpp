@@ -0,0 +1,282 @@
+// topology.cpp
+//
+
+#include "osal/topology.h"
+#include "osal/clock.h"
+#include "osal/thread.h"
+#include "cpu_list.h"
+#include "x86_cpuid.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace os {
+namespace topology {
+
+static std::string cpu_path(unsigned cpu, const char* rel)
+{
+    char path[128];
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/%s", cpu, rel);
+    return path;
+}
+
+static bool read_unsigned(const std::string& path, unsigned& out)
+{
+    auto line = detail::read_line(path.c_str());
+    if (line.empty())
+        return false;
+    out = static_cast<unsigned>(std::strtoul(line.c_str(), nullptr, 10));
+    return true;
+}
+
+/// "48K", "2048K", "32M"
+static std::size_t parse_size(const std::string& text)
+{
+    char* end;
+    auto n = static_cast<std::size_t>(std::strtoull(text.c_str(), &end, 10));
+    switch (*end)
+    {
+    case 'K': return n << 10;
+    case 'M': return n << 20;
+    case 'G': return n << 30;
+    default: return n;
+    }
+}
+
+static void add_cache(machine& m, const cache& c)
+{
+    for (auto& existing : m.caches)
+    {
+        if (existing.level == c.level && existing.type == c.type && existing.shared_cpus == c.shared_cpus)
+            return;
+    }
+    m.caches.push_back(c);
+}
+
+static bool from_sysfs(machine& m)
+{
+    std::map<std::pair<unsigned, unsigned>, unsigned> cores; // (package, core_id) to index
+    for (auto id : online_cpus())
+    {
+        unsigned package = 0, core_id = 0;
+        if (!read_unsigned(cpu_path(id, "topology/physical_package_id"), package) ||
+            !read_unsigned(cpu_path(id, "topology/core_id"), core_id))
+            return false;
+
+        auto key = std::make_pair(package, core_id);
+        auto it  = cores.find(key);
+        if (it == cores.end())
+            it = cores.emplace(key, static_cast<unsigned>(cores.size())).first;
+        m.cpus.push_back(cpu{id, it->second, package, 0});
+        m.packages = std::max(m.packages, package + 1);
+    }
+    m.cores = static_cast<unsigned>(cores.size());
+
+    auto nodes = detail::parse_cpu_list(detail::read_line("/sys/devices/system/node/online").c_str());
+    for (auto node : nodes)
+    {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist", node);
+        for (auto id : detail::parse_cpu_list(detail::read_line(path).c_str()))
+        {
+            for (auto& c : m.cpus)
+            {
+                if (c.id == id)
+                    c.node = node;
+            }
+        }
+    }
+    m.nodes = std::max<unsigned>(1, static_cast<unsigned>(nodes.size()));
+
+    for (auto& c : m.cpus)
+    {
+        for (unsigned index = 0;; index++)
+        {
+            char rel[64];
+            auto attr = [&](const char* name) {
+                snprintf(rel, sizeof(rel), "cache/index%u/%s", index, name);
+                return cpu_path(c.id, rel);
+            };
+
+            cache k{};
+            if (!read_unsigned(attr("level"), k.level))
+                break;
+            auto type = detail::read_line(attr("type").c_str());
+            k.type    = type == "Data" ? cache_type::data
+                      : type == "Instruction" ? cache_type::instruction
+                                              : cache_type::unified;
+            k.size    = parse_size(detail::read_line(attr("size").c_str()));
+            read_unsigned(attr("coherency_line_size"), k.line_size);
+            read_unsigned(attr("ways_of_associativity"), k.ways);
+            k.shared_cpus = detail::parse_cpu_list(detail::read_line(attr("shared_cpu_list").c_str()).c_str());
+            if (k.shared_cpus.empty())
+                k.shared_cpus.push_back(c.id);
+            add_cache(m, k);
+        }
+    }
+    return !m.cpus.empty();
+}
+
+/// Every CPU its own core, caches from the deterministic cache parameters leaf
+static void from_cpuid(machine& m)
+{
+    m = machine{};
+    for (auto id : online_cpus())
+        m.cpus.push_back(cpu{id, static_cast<unsigned>(m.cpus.size()), 0, 0});
+    m.cores    = static_cast<unsigned>(m.cpus.size());
+    m.packages = 1;
+    m.nodes    = 1;
+
+#if OSAL_HAS_TSC
+    unsigned regs[4];
+    detail::cpuid(0, 0, regs);
+    bool amd      = regs[1] == 0x68747541; // "Auth"enticAMD
+    unsigned leaf = 4;
+    if (amd)
+    {
+        detail::cpuid(0x80000000, 0, regs);
+        if (regs[0] < 0x8000001D)
+            return;
+        leaf = 0x8000001D;
+    }
+    else if (regs[0] < 4)
+    {
+        return;
+    }
+
+    std::vector<unsigned> all;
+    for (auto& c : m.cpus)
+        all.push_back(c.id);
+
+    for (unsigned sub = 0; sub < 16; sub++)
+    {
+        detail::cpuid(leaf, sub, regs);
+        auto type = regs[0] & 0x1f;
+        if (type == 0)
+            break;
+
+        cache k{};
+        k.level     = (regs[0] >> 5) & 0x7;
+        k.type      = type == 1 ? cache_type::data : type == 2 ? cache_type::instruction : cache_type::unified;
+        k.ways      = (regs[1] >> 22) + 1;
+        k.line_size = (regs[1] & 0xfff) + 1;
+        k.size      = static_cast<std::size_t>(k.ways) * (((regs[1] >> 12) & 0x3ff) + 1) * k.line_size * (regs[2] + 1);
+
+        // Sharing is not reported in a usable form, assume private L1/L2 and a shared last level
+        if (k.level <= 2)
+        {
+            for (auto id : all)
+            {
+                k.shared_cpus = {id};
+                add_cache(m, k);
+            }
+        }
+        else
+        {
+            k.shared_cpus = all;
+            add_cache(m, k);
+        }
+    }
+#endif
+}
+
+static machine discover()
+{
+    machine m{};
+#ifdef __linux__
+    if (!from_sysfs(m))
+        from_cpuid(m);
+#else
+    from_cpuid(m);
+#endif
+    std::stable_sort(m.caches.begin(), m.caches.end(), [](const cache& a, const cache& b) { return a.level < b.level; });
+    return m;
+}
+
+const machine& get()
+{
+    static const machine m = discover();
+    return m;
+}
+
+static const cpu* find(unsigned id)
+{
+    for (auto& c : get().cpus)
+    {
+        if (c.id == id)
+            return &c;
+    }
+    return nullptr;
+}
+
+static const cache* find_cache(unsigned id, unsigned level)
+{
+    for (auto& k : get().caches)
+    {
+        if (k.level == level && k.type != cache_type::instruction &&
+            std::binary_search(k.shared_cpus.begin(), k.shared_cpus.end(), id))
+            return &k;
+    }
+    return nullptr;
+}
+
+std::vector<unsigned> smt_siblings(unsigned cpu)
+{
+    std::vector<unsigned> out;
+    auto self = find(cpu);
+    if (!self)
+        return out;
+    for (auto& c : get().cpus)
+    {
+        if (c.core == self->core)
+            out.push_back(c.id);
+    }
+    return out;
+}
+
+std::vector<unsigned> sharing_cache(unsigned cpu, unsigned level)
+{
+    auto k = find_cache(cpu, level);
+    return k ? k->shared_cpus : std::vector<unsigned>{};
+}
+
+unsigned node_of(unsigned cpu)
+{
+    auto c = find(cpu);
+    return c ? c->node : 0;
+}
+
+std::vector<unsigned> cpus_of_node(unsigned node)
+{
+    std::vector<unsigned> out;
+    for (auto& c : get().cpus)
+    {
+        if (c.node == node)
+            out.push_back(c.id);
+    }
+    return out;
+}
+
+std::size_t cache_size(unsigned level)
+{
+    auto& cpus = get().cpus;
+    if (cpus.empty())
+        return 0;
+    auto k = find_cache(cpus.front().id, level);
+    return k ? k->size : 0;
+}
+
+unsigned cache_line_size()
+{
+    for (auto& k : get().caches)
+    {
+        if (k.line_size)
+            return k.line_size;
+    }
+    return 64;
+}
+
+} // namespace topology
+} // namespace os
@@ -0,0 +1,233 @@
+// trace.cpp
+//
+
+#include "osal/trace.h"
+#include "osal/os.h"
+#include "per_thread.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace os {
+namespace trace {
+
+#ifdef OSAL_TRACE
+bool enabled() { return true; }
+#else
+bool enabled() { return false; }
+#endif
+
+namespace detail {
+
+/// Spans kept per thread, must be a power of 2
+static constexpr std::size_t ring_capacity = 1 << 14;
+
+static uint64_t current_tid()
+{
+#ifdef _WIN32
+    return GetCurrentThreadId();
+#elif defined(__APPLE__)
+    uint64_t tid = 0;
+    pthread_threadid_np(nullptr, &tid);
+    return tid;
+#elif defined(__linux__)
+    return static_cast<uint64_t>(syscall(SYS_gettid));
+#else
+    return reinterpret_cast<uint64_t>(pthread_self());
+#endif
+}
+
+static uint64_t current_pid()
+{
+#ifdef _WIN32
+    return static_cast<uint64_t>(_getpid());
+#else
+    return static_cast<uint64_t>(getpid());
+#endif
+}
+
+struct record_t {
+    const char* name;
+    const char* category;
+    uint64_t tid;
+    uint64_t start;
+    uint64_t end;
+};
+
+/// One ring slot, a seqlock so chrome_json() can copy it while the owner overwrites it
+struct slot {
+    std::atomic<uint64_t> seq{0}; // index + 1 of the span held, 0 while being written
+    std::atomic<const char*> name{nullptr};
+    std::atomic<const char*> category{nullptr};
+    std::atomic<uint64_t> tid{0};
+    std::atomic<uint64_t> start{0};
+    std::atomic<uint64_t> end{0};
+};
+
+/// Written only by its thread, read by chrome_json() and cleared by reset()
+struct thread_buffer {
+    thread_buffer()
+        : tid(current_tid())
+        , slots(new slot[ring_capacity])
+    {}
+
+    void push(const record_t& r)
+    {
+        auto h = head.load(std::memory_order_relaxed);
+        auto& s = slots[h & (ring_capacity - 1)];
+        s.seq.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        s.name.store(r.name, std::memory_order_relaxed);
+        s.category.store(r.category, std::memory_order_relaxed);
+        s.tid.store(r.tid, std::memory_order_relaxed);
+        s.start.store(r.start, std::memory_order_relaxed);
+        s.end.store(r.end, std::memory_order_relaxed);
+        s.seq.store(h + 1, std::memory_order_release);
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    /// Call @p f with every span still in the ring, skipping ones overwritten while copying
+    template <typename F>
+    void read(F f) const
+    {
+        auto h  = head.load(std::memory_order_acquire);
+        auto lo = std::max(first.load(std::memory_order_relaxed), h > ring_capacity ? h - ring_capacity : 0);
+        for (auto i = lo; i < h; i++)
+        {
+            auto& s = slots[i & (ring_capacity - 1)];
+            if (s.seq.load(std::memory_order_acquire) != i + 1)
+                continue;
+            record_t r{s.name.load(std::memory_order_relaxed), s.category.load(std::memory_order_relaxed),
+                s.tid.load(std::memory_order_relaxed), s.start.load(std::memory_order_relaxed),
+                s.end.load(std::memory_order_relaxed)};
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.seq.load(std::memory_order_relaxed) != i + 1)
+                continue;
+            f(r);
+        }
+    }
+
+    /// Used when a thread exits, its spans move into the retired ring
+    void merge(const thread_buffer& other)
+    {
+        other.read([this](const record_t& r) { push(r); });
+    }
+
+    void reset() { first.store(head.load(std::memory_order_acquire), std::memory_order_relaxed); }
+
+    uint64_t tid;
+    std::unique_ptr<slot[]> slots;
+    std::atomic<uint64_t> head{0};  // written by the owner
+    std::atomic<uint64_t> first{0}; // written by reset()
+};
+
+using buffers = os::detail::per_thread<thread_buffer>;
+
+/// Pairs a cycle reading with the monotonic clock so spans can be placed on it
+struct epoch {
+    epoch()
+        : cycles(clock::cycles())
+        , ns(clock::monotonic_ns())
+    {}
+
+    uint64_t cycles;
+    uint64_t ns;
+};
+
+static const epoch& get_epoch()
+{
+    static epoch e;
+    return e;
+}
+
+void record(const char* name, const char* category, uint64_t start_cycles, uint64_t end_cycles)
+{
+    auto& b = buffers::local();
+    b.push(record_t{name, category, b.tid, start_cycles, end_cycles});
+}
+
+static void append_escaped(std::string& out, const char* s)
+{
+    for (; s && *s; s++)
+    {
+        auto c = static_cast<unsigned char>(*s);
+        if (c == '"' || c == '\\')
+        {
+            out += '\\';
+            out += static_cast<char>(c);
+        }
+        else if (c < 0x20)
+        {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", c);
+            out += esc;
+        }
+        else
+        {
+            out += static_cast<char>(c);
+        }
+    }
+}
+
+} // namespace detail
+
+std::string chrome_json()
+{
+    std::vector<detail::record_t> spans;
+    detail::buffers::for_each([&spans](detail::thread_buffer& t) {
+        t.read([&spans](const detail::record_t& r) { spans.push_back(r); });
+    });
+    std::sort(spans.begin(), spans.end(),
+        [](const detail::record_t& a, const detail::record_t& b) { return a.start < b.start; });
+
+    auto& e  = detail::get_epoch();
+    auto cpn = clock::cycles_per_ns();
+    auto to_us = [&e, cpn](uint64_t cycles) {
+        auto delta = static_cast<double>(static_cast<int64_t>(cycles - e.cycles)) / cpn;
+        return (static_cast<double>(e.ns) + delta) / 1000.0;
+    };
+    auto pid = static_cast<unsigned long long>(detail::current_pid());
+
+    std::string out = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    char line[160];
+    bool first = true;
+    for (auto& r : spans)
+    {
+        out += first ? "\n" : ",\n";
+        first = false;
+        out += "{\"name\":\"";
+        detail::append_escaped(out, r.name ? r.name : "(unnamed)");
+        out += "\",\"cat\":\"";
+        detail::append_escaped(out, r.category);
+        auto dur = r.end > r.start ? static_cast<double>(r.end - r.start) / cpn / 1000.0 : 0.0;
+        snprintf(line, sizeof(line), "\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%llu,\"tid\":%llu}",
+            to_us(r.start), dur, pid, static_cast<unsigned long long>(r.tid));
+        out += line;
+    }
+    out += "\n]}\n";
+    return out;
+}
+
+bool dump(const char* path)
+{
+    auto json = chrome_json();
+    return file::dump(path, json.data(), json.size()) == json.size();
+}
+
+void reset() { detail::buffers::reset(); }
+
+} // namespace trace
+} // namespace os
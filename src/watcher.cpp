@@ -0,0 +1,409 @@
+// watcher.cpp
+//
+
+#include "osal/watcher.h"
+#include "osal/thread_pool.h"
+#include "osal/trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace os {
+namespace file {
+
+#ifdef __linux__
+static constexpr uint32_t watch_mask = IN_CREATE | IN_MODIFY | IN_CLOSE_WRITE | IN_DELETE | IN_MOVED_FROM |
+                                       IN_MOVED_TO | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+#endif
+
+static std::string normalize(const std::string& path)
+{
+    auto end = path.find_last_not_of('/');
+    return end == std::string::npos ? path.substr(0, 1) : path.substr(0, end + 1);
+}
+
+watcher::watcher(uint64_t coalesce_ns, std::size_t capacity)
+    : m_window(coalesce_ns)
+    , m_queue(memory::make_aligned<mpmc_queue<watch_event>>(capacity, true))
+{
+    start();
+}
+
+watcher::watcher(callback cb, uint64_t coalesce_ns)
+    : m_window(coalesce_ns)
+    , m_cb(std::make_shared<callback>(std::move(cb)))
+{
+    start();
+}
+
+watcher::watcher(thread_pool& pool, callback cb, uint64_t coalesce_ns)
+    : m_window(coalesce_ns)
+    , m_cb(std::make_shared<callback>(std::move(cb)))
+    , m_pool(&pool)
+{
+    start();
+}
+
+watcher::~watcher()
+{
+    stop();
+#ifdef __linux__
+    if (m_fd >= 0)
+        ::close(m_fd);
+    if (m_wake_fd >= 0)
+        ::close(m_wake_fd);
+#endif
+}
+
+void watcher::start()
+{
+#ifdef __linux__
+    m_fd      = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    m_wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (m_fd >= 0 && m_wake_fd >= 0)
+        m_thread = std::thread(&watcher::run, this);
+#endif
+}
+
+void watcher::stop()
+{
+    m_stopping = true;
+#ifdef __linux__
+    if (m_wake_fd >= 0)
+    {
+        uint64_t one = 1;
+        auto rc      = ::write(m_wake_fd, &one, sizeof(one));
+        (void)rc;
+    }
+#endif
+    if (m_thread.joinable() && m_thread.get_id() != std::this_thread::get_id())
+        m_thread.join();
+}
+
+bool watcher::add(const std::string& path, bool recursive)
+{
+    if (!m_thread.joinable() || !is_dir(path))
+        return false;
+    auto top = normalize(path);
+    recursive_mutex_lock lock(m_mtx);
+    if (!watch_tree(top, recursive, false))
+        return false;
+    for (auto& r : m_roots)
+    {
+        if (r.path == top)
+        {
+            r.recursive = r.recursive || recursive;
+            return true;
+        }
+    }
+    m_roots.push_back(dir{top, recursive});
+    return true;
+}
+
+bool watcher::remove(const std::string& path)
+{
+    auto top = normalize(path);
+    recursive_mutex_lock lock(m_mtx);
+    auto it = std::find_if(m_roots.begin(), m_roots.end(), [&](const dir& r) { return r.path == top; });
+    if (it == m_roots.end())
+        return false;
+    m_roots.erase(it);
+    return unwatch_below(top);
+}
+
+bool watcher::poll(watch_event& out, int64_t timeout_ns)
+{
+    if (!m_queue)
+        return false;
+    return m_queue->pop_wait(out, timeout_ns);
+}
+
+std::size_t watcher::watch_count() const
+{
+    recursive_mutex_lock lock(m_mtx);
+    return m_dirs.size();
+}
+
+/// Adds a watch for @p path and, if @p recursive, for every directory below it. With @p report
+/// the entries found are recorded as created, they may have appeared before the watch did.
+bool watcher::watch_tree(const std::string& path, bool recursive, bool report)
+{
+#ifdef __linux__
+    std::vector<std::string> todo{path};
+    while (!todo.empty())
+    {
+        auto current = std::move(todo.back());
+        todo.pop_back();
+
+        auto wd = inotify_add_watch(m_fd, current.c_str(), watch_mask);
+        if (wd < 0)
+        {
+            if (current == path)
+                return false;
+            continue; // removed meanwhile or out of watches, the rest of the tree still counts
+        }
+        m_dirs[wd]         = dir{current, recursive};
+        m_watches[current] = wd;
+        if (!recursive && !report)
+            continue;
+
+        auto d = opendir(current.c_str());
+        if (!d)
+            continue;
+        while (auto entry = readdir(d))
+        {
+            if (std::strcmp(entry->d_name, ".") == 0 || std::strcmp(entry->d_name, "..") == 0)
+                continue;
+            auto child  = join(current, entry->d_name);
+            bool is_dir = entry->d_type == DT_DIR;
+            if (entry->d_type == DT_UNKNOWN)
+            {
+                struct stat st;
+                is_dir = lstat(child.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+            }
+            if (report)
+                record(child, created, is_dir);
+            if (is_dir && recursive)
+                todo.push_back(std::move(child));
+        }
+        closedir(d);
+    }
+    return true;
+#else
+    (void)path;
+    (void)recursive;
+    (void)report;
+    return false;
+#endif
+}
+
+/// Drops the watches on @p path and every directory below it
+bool watcher::unwatch_below(const std::string& path)
+{
+    bool found = false;
+#ifdef __linux__
+    for (auto it = m_watches.begin(); it != m_watches.end();)
+    {
+        auto& p = it->first;
+        if (p == path || (p.size() > path.size() && p.compare(0, path.size(), path) == 0 && p[path.size()] == '/'))
+        {
+            inotify_rm_watch(m_fd, it->second);
+            m_dirs.erase(it->second);
+            it    = m_watches.erase(it);
+            found = true;
+        }
+        else
+        {
+            ++it;
+        }
+    }
+#else
+    (void)path;
+#endif
+    return found;
+}
+
+void watcher::handle(int wd, uint32_t mask, const char* name)
+{
+#ifdef __linux__
+    if (mask & IN_Q_OVERFLOW)
+    {
+        overflow();
+        return;
+    }
+
+    recursive_mutex_lock lock(m_mtx);
+    auto it = m_dirs.find(wd);
+    if (it == m_dirs.end())
+        return; // already dropped by remove(), unwatch_below() or a rebuild
+    if (mask & IN_IGNORED)
+    {
+        auto w = m_watches.find(it->second.path);
+        if (w != m_watches.end() && w->second == wd)
+            m_watches.erase(w);
+        m_dirs.erase(it);
+        return;
+    }
+
+    auto parent = it->second; // handling below may rehash m_dirs
+    bool is_dir = (mask & IN_ISDIR) != 0;
+    if (mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+    {
+        // Entries below a root are reported through their parent's watch
+        auto root = std::find_if(m_roots.begin(), m_roots.end(), [&](const dir& r) { return r.path == parent.path; });
+        if (root != m_roots.end())
+            record(parent.path, deleted, true);
+        if (mask & IN_MOVE_SELF)
+            unwatch_below(parent.path); // the watch follows the inode, its path is stale now
+        return;
+    }
+
+    auto path        = name && *name ? join(parent.path, name) : parent.path;
+    unsigned changes = 0;
+    if (mask & (IN_CREATE | IN_MOVED_TO))
+        changes |= created;
+    if (mask & IN_MODIFY)
+        changes |= modified;
+    if (mask & IN_CLOSE_WRITE)
+        changes |= closed;
+    if (mask & (IN_DELETE | IN_MOVED_FROM))
+        changes |= deleted;
+    if (mask & IN_ATTRIB)
+        changes |= attrib;
+
+    if (is_dir && (mask & IN_MOVED_FROM))
+        unwatch_below(path);
+    record(path, changes, is_dir);
+    if (is_dir && (changes & created) && parent.recursive)
+        watch_tree(path, true, true);
+#else
+    (void)wd;
+    (void)mask;
+    (void)name;
+#endif
+}
+
+/// The kernel dropped events, so directories may have come and gone unseen. Rebuild every watch
+/// from the roots and tell the consumer to list them again.
+void watcher::overflow()
+{
+#ifdef __linux__
+    recursive_mutex_lock lock(m_mtx);
+    for (auto& d : m_dirs)
+        inotify_rm_watch(m_fd, d.first);
+    m_dirs.clear();
+    m_watches.clear();
+    for (auto& r : m_roots)
+    {
+        watch_tree(r.path, r.recursive, false);
+        record(r.path, rescan, true);
+    }
+#endif
+}
+
+void watcher::record(std::string path, unsigned changes, bool is_dir)
+{
+    auto it = m_index.find(path);
+    if (it != m_index.end())
+    {
+        auto& e = m_pending[it->second - m_flushed].event;
+        e.changes |= changes;
+        e.is_dir = is_dir;
+        return;
+    }
+    m_index.emplace(path, m_flushed + m_pending.size());
+    m_pending.push_back(pending{watch_event{std::move(path), changes, is_dir}, clock::monotonic_ns()});
+}
+
+/// Dispatches every event whose window has closed
+/// @return ns until the next window closes, -1 if nothing is pending
+int64_t watcher::flush()
+{
+    if (m_lost)
+        catch_up();
+    auto now = clock::monotonic_ns();
+    while (!m_pending.empty())
+    {
+        auto& front = m_pending.front();
+        auto due    = front.first_ns + m_window;
+        if (due > now)
+            return static_cast<int64_t>(due - now);
+        auto e = std::move(front.event);
+        m_index.erase(e.path);
+        m_pending.pop_front();
+        m_flushed++;
+        dispatch(e);
+    }
+    return -1;
+}
+
+/// Queues the rescan events owed since the queue overflowed
+/// @return false while the queue is still full
+bool watcher::catch_up()
+{
+    std::vector<dir> roots;
+    {
+        recursive_mutex_lock lock(m_mtx);
+        roots = m_roots;
+    }
+    for (auto& r : roots)
+    {
+        if (!m_queue->try_push(watch_event{r.path, rescan, true}))
+            return false;
+    }
+    m_lost = false;
+    return true;
+}
+
+void watcher::dispatch(watch_event& e)
+{
+    if (m_queue)
+    {
+        if (m_lost && !catch_up())
+            return; // still full, the rescan covers this event too
+        if (!m_queue->try_push(std::move(e)))
+            m_lost = true;
+        return;
+    }
+    if (m_pool)
+    {
+        auto cb = m_cb;
+        auto job = std::make_shared<watch_event>(std::move(e));
+        if (m_pool->post([cb, job]() {
+                trace::span span("watch", "watcher");
+                (*cb)(*job);
+            }))
+            return;
+        e = std::move(*job);
+    }
+    trace::span span("watch", "watcher");
+    (*m_cb)(e);
+}
+
+void watcher::run()
+{
+#ifdef __linux__
+    alignas(inotify_event) char buf[64 * 1024];
+    const int64_t retry_ns = static_cast<int64_t>(std::max<uint64_t>(m_window, clock::ms_to_ns(1)));
+    while (!m_stopping)
+    {
+        auto timeout = flush();
+        if (m_lost && (timeout < 0 || timeout > retry_ns))
+            timeout = retry_ns;
+
+        pollfd fds[2] = {{m_fd, POLLIN, 0}, {m_wake_fd, POLLIN, 0}};
+        timespec ts{static_cast<time_t>(timeout / 1000000000), static_cast<long>(timeout % 1000000000)};
+        if (ppoll(fds, 2, timeout < 0 ? nullptr : &ts, nullptr) < 0 && errno != EINTR)
+            break;
+        if (m_stopping)
+            break;
+        if (!(fds[0].revents & POLLIN))
+            continue;
+
+        for (;;)
+        {
+            auto n = ::read(m_fd, buf, sizeof(buf));
+            if (n <= 0)
+                break;
+            for (char* p = buf; p < buf + n;)
+            {
+                auto ev = reinterpret_cast<const inotify_event*>(p);
+                handle(ev->wd, ev->mask, ev->len ? ev->name : nullptr);
+                p += sizeof(inotify_event) + ev->len;
+            }
+        }
+    }
+#endif
+}
+
+} // namespace file
+} // namespace os
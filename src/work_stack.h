@@ -0,0 +1,119 @@
+// work_stack.h
+//
+
+#ifndef OSAL_WORK_STACK_H
+#define OSAL_WORK_STACK_H
+
+#include "osal/os.h"
+#include "osal/park.h"
+#include "osal/thread_pool.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace os {
+namespace detail {
+
+/// @brief Work items shared by the threads of a tree walk
+///
+/// Every thread calls drain(); processing an item may push more. drain() returns once nothing is
+/// queued and no other thread is still processing, so one item can fan out into a whole tree.
+template <typename T>
+class work_stack {
+public:
+    explicit work_stack(const char* name)
+        : m_mtx(name)
+    {}
+    work_stack(const work_stack& other) = delete;
+    work_stack& operator=(const work_stack& other) = delete;
+    work_stack(work_stack&& other) noexcept = delete;
+    work_stack& operator=(work_stack&& other) noexcept = delete;
+
+    /// Moves @p items onto the stack and leaves it empty
+    void push(std::vector<T>& items)
+    {
+        if (items.empty())
+            return;
+        m_pending.fetch_add(items.size());
+        {
+            recursive_mutex_lock lock(m_mtx);
+            for (auto& i : items)
+                m_todo.push_back(std::move(i));
+        }
+        items.clear();
+        if (m_idle.load() != 0)
+            wake();
+    }
+
+    /// @brief Calls @p fn(item, found) for items until none are queued or being processed
+    ///
+    /// Whatever @p fn leaves in found is pushed before the item counts as done.
+    template <typename Fn>
+    void drain(Fn&& fn)
+    {
+        std::vector<T> found;
+        T item;
+        for (;;)
+        {
+            if (!pop(item))
+            {
+                // Announce idleness before the last look so a push either sees us or we see it
+                m_idle.fetch_add(1);
+                auto epoch = m_epoch.load();
+                bool more  = pop(item);
+                if (!more && m_pending.load() != 0)
+                    park(m_epoch, epoch);
+                m_idle.fetch_sub(1);
+                if (!more)
+                {
+                    if (m_pending.load() == 0)
+                        return;
+                    continue;
+                }
+            }
+            fn(item, found);
+            push(found);
+            if (m_pending.fetch_sub(1) == 1)
+                wake();
+        }
+    }
+
+private:
+    bool pop(T& out)
+    {
+        recursive_mutex_lock lock(m_mtx);
+        if (m_todo.empty())
+            return false;
+        out = std::move(m_todo.back()); // depth first keeps the stack small
+        m_todo.pop_back();
+        return true;
+    }
+
+    void wake()
+    {
+        m_epoch.fetch_add(1);
+        unpark_all(m_epoch);
+    }
+
+    os::recursive_mutex m_mtx;
+    std::vector<T> m_todo;
+    std::atomic<std::size_t> m_pending{0}; // queued or being processed
+    std::atomic<uint32_t> m_idle{0};
+    std::atomic<uint32_t> m_epoch{0};
+};
+
+/// @brief @p pool, or a temporary pool of @p threads workers kept alive by @p own
+inline thread_pool& pool_or_temporary(thread_pool* pool, std::size_t threads, std::unique_ptr<thread_pool>& own)
+{
+    if (pool)
+        return *pool;
+    own.reset(new thread_pool(threads));
+    return *own;
+}
+
+} // namespace detail
+} // namespace os
+
+#endif // OSAL_WORK_STACK_H
@@ -0,0 +1,47 @@
+// x86_cpuid.h
+//
+
+#ifndef OSAL_X86_CPUID_H
+#define OSAL_X86_CPUID_H
+
+#include "osal/clock.h"
+#include <cstdint>
+
+#if OSAL_HAS_TSC && !defined(_MSC_VER)
+#include <cpuid.h>
+#endif
+
+namespace os {
+namespace detail {
+
+#if OSAL_HAS_TSC
+/// @brief eax, ebx, ecx, edx of cpuid @p leaf / @p subleaf
+inline void cpuid(unsigned leaf, unsigned subleaf, unsigned regs[4])
+{
+#ifdef _MSC_VER
+    int r[4];
+    __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; i++)
+        regs[i] = static_cast<unsigned>(r[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+/// @brief Register state the OS saves on context switches (XCR0), only valid with OSXSAVE
+inline uint64_t xgetbv()
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+#endif
+
+} // namespace detail
+} // namespace os
+
+#endif // OSAL_X86_CPUID_H
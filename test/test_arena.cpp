@@ -0,0 +1,93 @@
+#include "osal/arena.h"
+#include "osal/os.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+
+class TestArena : public ::testing::Test {
+public:
+    TestArena() {}
+
+    ~TestArena() override {}
+
+    void SetUp() override {}
+    void TearDown() override { os::file::delete_dir("arena_dir"); }
+};
+
+TEST_F(TestArena, allocate)
+{
+    os::arena a(1024);
+    auto p = a.allocate(10, 1);
+    auto q = a.allocate(8, 64);
+    EXPECT_NE(p, q);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(q) % 64, 0u);
+    EXPECT_EQ(a.chunks(), 1u);
+
+    // Larger than a chunk gets its own
+    a.allocate(4096);
+    EXPECT_EQ(a.chunks(), 2u);
+
+    auto used = a.used();
+    EXPECT_GE(used, 10u + 8u + 4096u);
+    a.reset();
+    EXPECT_EQ(a.used(), 0u);
+
+    // The same work after a reset reuses the chunks
+    a.allocate(10, 1);
+    a.allocate(8, 64);
+    a.allocate(4096);
+    EXPECT_EQ(a.chunks(), 2u);
+}
+
+TEST_F(TestArena, copy)
+{
+    os::arena a(16);
+    std::string s = "a string longer than one chunk";
+    auto r = a.copy(s);
+    EXPECT_NE(r.data(), s.data());
+    EXPECT_EQ(r, os::string_ref(s));
+    EXPECT_EQ(r.data()[r.size()], '\0');
+    EXPECT_EQ(r.str(), s);
+    EXPECT_TRUE(a.copy("").empty());
+}
+
+TEST_F(TestArena, vector)
+{
+    os::arena a;
+    os::arena_vector<int> v(a);
+    for (int i = 0; i < 1000; i++)
+        v.push_back(i);
+    EXPECT_EQ(v[999], 999);
+    EXPECT_GE(a.used(), 1000 * sizeof(int));
+}
+
+TEST_F(TestArena, paths)
+{
+    auto& a = os::arena::local();
+    a.reset();
+    EXPECT_EQ(os::file::get_stem("dir/sub/file.tar.gz", a), os::string_ref("file.tar"));
+    EXPECT_EQ(os::file::get_stem("dir.d/file", a), os::string_ref("file"));
+    EXPECT_EQ(os::file::get_filename("dir/sub/file.txt", a), os::string_ref("file.txt"));
+    EXPECT_EQ(os::file::get_filename("", a), os::string_ref(""));
+
+    auto joined = os::file::join("dir", "file.txt", a);
+    EXPECT_EQ(joined.str(), os::file::join(std::string("dir"), std::string("file.txt")));
+    EXPECT_EQ(joined.data()[joined.size()], '\0');
+}
+
+TEST_F(TestArena, list_dir)
+{
+    ASSERT_TRUE(os::file::create_dir("arena_dir"));
+    for (int i = 0; i < 50; i++)
+        os::file::touch(os::file::join("arena_dir", std::to_string(i)).c_str());
+
+    os::arena a;
+    auto names = os::file::list_dir("arena_dir", a);
+    ASSERT_EQ(names.size(), 50u);
+    auto expected = os::file::list_dir("arena_dir");
+    for (auto& name : names)
+        EXPECT_NE(std::find(expected.begin(), expected.end(), name.str()), expected.end());
+    EXPECT_EQ(a.chunks(), 1u);
+
+    EXPECT_TRUE(os::file::list_dir("arena_missing", a).empty());
+}
@@ -0,0 +1,60 @@
+#include "osal/clock.h"
+#include "osal/os.h"
+#include <gtest/gtest.h>
+
+class TestClock : public ::testing::Test {
+public:
+    TestClock() {}
+
+    ~TestClock() override {}
+
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(TestClock, monotonic)
+{
+    auto t1 = os::clock::monotonic_ns();
+    auto t2 = os::clock::monotonic_ns();
+    EXPECT_GE(t2, t1);
+
+    os::sleep(20);
+    auto t3 = os::clock::monotonic_ns();
+    EXPECT_GE(t3 - t1, os::clock::ms_to_ns(20));
+    EXPECT_LT(t3 - t1, os::clock::s_to_ns(2));
+
+    auto coarse = os::clock::monotonic_coarse_ns();
+    EXPECT_GT(coarse, t1 - os::clock::ms_to_ns(50));
+}
+
+TEST_F(TestClock, realtime)
+{
+    auto now = os::clock::realtime_ns();
+    EXPECT_NEAR(static_cast<double>(os::clock::ns_to_s(now)), static_cast<double>(os::time_since_epoch()), 2.0);
+}
+
+TEST_F(TestClock, cycles)
+{
+    os::clock::calibrate();
+    EXPECT_GT(os::clock::cycles_per_ns(), 0.0);
+
+    auto c1 = os::clock::cycles();
+    auto t1 = os::clock::monotonic_ns();
+    os::sleep(50);
+    auto c2 = os::clock::cycles();
+    auto t2 = os::clock::monotonic_ns();
+
+    auto elapsed = static_cast<double>(t2 - t1);
+    EXPECT_NEAR(static_cast<double>(os::clock::cycles_to_ns(c2 - c1)), elapsed, elapsed * 0.1);
+    EXPECT_NEAR(static_cast<double>(os::clock::ns_to_cycles(os::clock::cycles_to_ns(1000000))), 1000000.0, 1000.0);
+}
+
+TEST_F(TestClock, conversions)
+{
+    EXPECT_EQ(os::clock::us_to_ns(3), 3000u);
+    EXPECT_EQ(os::clock::ms_to_ns(3), 3000000u);
+    EXPECT_EQ(os::clock::s_to_ns(3), 3000000000u);
+    EXPECT_EQ(os::clock::ns_to_us(3999), 3u);
+    EXPECT_EQ(os::clock::ns_to_ms(3999999), 3u);
+    EXPECT_EQ(os::clock::ns_to_s(3999999999), 3u);
+}
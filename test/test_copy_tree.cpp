@@ -0,0 +1,173 @@
+#include "osal/copy_tree.h"
+#include "osal/os.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+class TestCopyTree : public ::testing::Test {
+public:
+    TestCopyTree() {}
+
+    ~TestCopyTree() override {}
+
+    void SetUp() override
+    {
+        TearDown();
+        os::file::create_dir(m_src);
+        os::file::create_dir(m_src + "/sub");
+        os::file::create_dir(m_src + "/sub/deep");
+        os::file::dump(m_src + "/a", std::string(100, 'a'));
+        os::file::dump(m_src + "/sub/b", std::string(5000, 'b'));
+        os::file::dump(m_src + "/sub/deep/c", "c");
+    }
+    void TearDown() override
+    {
+        for (auto dir : {m_src, m_dst, m_snap})
+            os::file::delete_dir(dir);
+    }
+
+    static std::string slurp(const std::string& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        std::stringstream ss;
+        ss << in.rdbuf();
+        return ss.str();
+    }
+
+protected:
+    const std::string m_src{"./test_copy_tree_src"};
+    const std::string m_dst{"./test_copy_tree_dst"};
+    const std::string m_snap{"./test_copy_tree_snap"};
+};
+
+#ifndef _WIN32
+
+TEST_F(TestCopyTree, copy)
+{
+    ASSERT_EQ(symlink("sub/b", (m_src + "/link").c_str()), 0);
+    ASSERT_EQ(chmod((m_src + "/a").c_str(), 0640), 0);
+    ASSERT_EQ(chmod((m_src + "/sub/deep").c_str(), 0750), 0);
+    struct timespec old[2] = {{1000000000, 0}, {1000000000, 500}};
+    ASSERT_EQ(utimensat(AT_FDCWD, (m_src + "/sub/b").c_str(), old, 0), 0);
+    ASSERT_EQ(utimensat(AT_FDCWD, (m_src + "/sub").c_str(), old, 0), 0);
+
+    os::file::copy_options opt;
+    opt.threads = 2;
+    auto report = os::file::copy_tree(m_src, m_dst, opt);
+    EXPECT_EQ(report.errors, 0u);
+    EXPECT_EQ(report.files, 3u);
+    EXPECT_EQ(report.dirs, 3u);
+    EXPECT_EQ(report.symlinks, 1u);
+    EXPECT_EQ(report.linked, 0u);
+
+    EXPECT_EQ(slurp(m_dst + "/a"), std::string(100, 'a'));
+    EXPECT_EQ(slurp(m_dst + "/sub/b"), std::string(5000, 'b'));
+    EXPECT_EQ(slurp(m_dst + "/sub/deep/c"), "c");
+
+    struct stat st;
+    ASSERT_EQ(lstat((m_dst + "/a").c_str(), &st), 0);
+    EXPECT_EQ(st.st_mode & 07777, 0640u);
+    ASSERT_EQ(lstat((m_dst + "/sub/deep").c_str(), &st), 0);
+    EXPECT_EQ(st.st_mode & 07777, 0750u);
+    ASSERT_EQ(lstat((m_dst + "/sub/b").c_str(), &st), 0);
+    EXPECT_EQ(st.st_mtim.tv_sec, 1000000000);
+    EXPECT_EQ(st.st_mtim.tv_nsec, 500);
+    ASSERT_EQ(lstat((m_dst + "/sub").c_str(), &st), 0);
+    EXPECT_EQ(st.st_mtim.tv_sec, 1000000000); // applied after its entries were written
+
+    char target[64] = {};
+    ASSERT_EQ(readlink((m_dst + "/link").c_str(), target, sizeof(target) - 1), 5);
+    EXPECT_STREQ(target, "sub/b");
+}
+
+TEST_F(TestCopyTree, sparse)
+{
+    const off_t size = 8 << 20;
+    auto path        = m_src + "/sparse";
+    int fd           = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(pwrite(fd, "head", 4, 0), 4);
+    ASSERT_EQ(pwrite(fd, "tail", 4, size - 4), 4);
+    ::close(fd);
+
+    os::file::copy_options opt;
+    opt.reflink = false;
+    auto report = os::file::copy_tree(m_src, m_dst, opt);
+    EXPECT_EQ(report.errors, 0u);
+
+    auto copy = slurp(m_dst + "/sparse");
+    ASSERT_EQ(copy.size(), static_cast<std::size_t>(size));
+    EXPECT_EQ(copy.substr(0, 4), "head");
+    EXPECT_EQ(copy.substr(copy.size() - 4), "tail");
+    EXPECT_EQ(copy.find_first_not_of('\0', 4), copy.size() - 4);
+
+    struct stat src, dst;
+    ASSERT_EQ(stat(path.c_str(), &src), 0);
+    ASSERT_EQ(stat((m_dst + "/sparse").c_str(), &dst), 0);
+    if (src.st_blocks * 512 < size) // the filesystem keeps holes at all
+    {
+        EXPECT_LT(dst.st_blocks * 512, size);
+        EXPECT_LT(report.bytes, static_cast<uint64_t>(size));
+    }
+}
+
+TEST_F(TestCopyTree, snapshot)
+{
+    ASSERT_EQ(os::file::copy_tree(m_src, m_snap).errors, 0u);
+
+    // Different size, so it differs from the snapshot whatever the timestamp granularity
+    os::file::dump(m_src + "/sub/b", std::string(10, 'B'));
+
+    os::file::copy_options opt;
+    opt.link_dest = m_snap;
+    auto report   = os::file::copy_tree(m_src, m_dst, opt);
+    EXPECT_EQ(report.errors, 0u);
+    EXPECT_EQ(report.files, 3u);
+    EXPECT_EQ(report.linked, 2u);
+
+    struct stat old, now;
+    ASSERT_EQ(stat((m_snap + "/sub/deep/c").c_str(), &old), 0);
+    ASSERT_EQ(stat((m_dst + "/sub/deep/c").c_str(), &now), 0);
+    EXPECT_EQ(old.st_ino, now.st_ino);
+    ASSERT_EQ(stat((m_snap + "/sub/b").c_str(), &old), 0);
+    ASSERT_EQ(stat((m_dst + "/sub/b").c_str(), &now), 0);
+    EXPECT_NE(old.st_ino, now.st_ino);
+    EXPECT_EQ(slurp(m_dst + "/sub/b"), std::string(10, 'B'));
+    EXPECT_EQ(slurp(m_snap + "/sub/b"), std::string(5000, 'b'));
+
+    // Copying again over the result must not write through the links into the snapshot
+    os::file::dump(m_src + "/a", std::string(7, 'A'));
+    report = os::file::copy_tree(m_src, m_dst);
+    EXPECT_EQ(report.errors, 0u);
+    EXPECT_EQ(slurp(m_dst + "/a"), std::string(7, 'A'));
+    EXPECT_EQ(slurp(m_snap + "/a"), std::string(100, 'a'));
+}
+
+TEST_F(TestCopyTree, into_itself)
+{
+    auto inner  = m_src + "/sub/snap";
+    auto report = os::file::copy_tree(m_src, inner);
+    EXPECT_EQ(report.errors, 0u);
+    EXPECT_EQ(report.files, 3u);
+    EXPECT_EQ(slurp(inner + "/sub/deep/c"), "c");
+    EXPECT_FALSE(os::file::is_dir(inner + "/sub/snap"));
+
+    EXPECT_EQ(os::file::copy_tree(m_src, m_src).errors, 1u);
+    EXPECT_EQ(os::file::copy_tree(m_src, m_src + "/sub/..").errors, 1u);
+}
+
+#endif
+
+TEST_F(TestCopyTree, missing)
+{
+    auto report = os::file::copy_tree(m_src + "/missing", m_dst);
+    EXPECT_EQ(report.errors, 1u);
+    EXPECT_FALSE(os::file::is_dir(m_dst));
+}
@@ -0,0 +1,73 @@
+#include "osal/cpu_features.h"
+#include <gtest/gtest.h>
+
+class TestCpuFeatures : public ::testing::Test {
+public:
+    TestCpuFeatures() {}
+
+    ~TestCpuFeatures() override {}
+
+    void SetUp() override {}
+    void TearDown() override { os::clear_forced_tier(); }
+};
+
+namespace {
+int kernel_scalar() { return 0; }
+int kernel_sse2() { return 1; }
+int kernel_avx2() { return 3; }
+} // namespace
+
+TEST_F(TestCpuFeatures, host)
+{
+    auto& f = os::cpu_features::host();
+    EXPECT_EQ(&f, &os::cpu_features::host());
+#if OSAL_SIMD_X86
+    EXPECT_TRUE(f.sse2);
+    EXPECT_GE(static_cast<int>(os::host_tier()), static_cast<int>(os::simd_tier::sse2));
+#endif
+    if (f.avx2)
+    {
+        EXPECT_TRUE(f.avx);
+    }
+    if (f.avx512bw)
+    {
+        EXPECT_TRUE(f.avx512f);
+    }
+    EXPECT_STREQ(os::tier_name(os::simd_tier::avx2), "avx2");
+}
+
+TEST_F(TestCpuFeatures, force_tier)
+{
+    os::clear_forced_tier();
+    EXPECT_EQ(os::active_tier(), os::host_tier());
+
+    os::force_tier(os::simd_tier::scalar);
+    EXPECT_EQ(os::active_tier(), os::simd_tier::scalar);
+
+    // Forcing above the host is clamped
+    os::force_tier(os::simd_tier::avx512);
+    EXPECT_EQ(os::active_tier(), os::host_tier());
+}
+
+TEST_F(TestCpuFeatures, dispatch)
+{
+    using fn = int (*)();
+    static const os::dispatch<fn> kernels{
+        {os::simd_tier::scalar, kernel_scalar},
+        {os::simd_tier::sse2, kernel_sse2},
+        {os::simd_tier::avx2, kernel_avx2}};
+
+    EXPECT_EQ(kernels.pick(os::simd_tier::scalar)(), 0);
+    EXPECT_EQ(kernels.pick(os::simd_tier::sse42)(), 1);
+    EXPECT_EQ(kernels.pick(os::simd_tier::avx512)(), 3);
+
+    auto expected = kernels.pick(os::host_tier())();
+    EXPECT_EQ(kernels.get()(), expected);
+
+    os::force_tier(os::simd_tier::scalar);
+    EXPECT_EQ(kernels.get()(), 0);
+    EXPECT_EQ(kernels.tier(), os::simd_tier::scalar);
+
+    os::clear_forced_tier();
+    EXPECT_EQ(kernels.get()(), expected);
+}
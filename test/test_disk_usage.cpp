@@ -0,0 +1,83 @@
+#include "osal/disk_usage.h"
+#include "osal/os.h"
+#include "osal/thread_pool.h"
+#include <gtest/gtest.h>
+#include <string>
+
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
+class TestDiskUsage : public ::testing::Test {
+public:
+    TestDiskUsage() {}
+
+    ~TestDiskUsage() override {}
+
+    void SetUp() override
+    {
+        os::file::delete_dir(m_dir);
+        os::file::create_dir(m_dir);
+        os::file::create_dir(m_dir + "/sub1");
+        os::file::create_dir(m_dir + "/sub1/deep");
+        os::file::create_dir(m_dir + "/sub2");
+        os::file::dump(m_dir + "/a", std::string(100, 'a'));
+        os::file::dump(m_dir + "/sub1/b", std::string(200, 'b'));
+        os::file::dump(m_dir + "/sub1/deep/c", std::string(300, 'c'));
+        os::file::dump(m_dir + "/sub2/d", std::string(50, 'd'));
+    }
+    void TearDown() override { os::file::delete_dir(m_dir); }
+
+protected:
+    const std::string m_dir{"./test_disk_usage"};
+};
+
+#ifndef _WIN32
+
+TEST_F(TestDiskUsage, totals)
+{
+    ASSERT_EQ(link((m_dir + "/sub2/d").c_str(), (m_dir + "/sub2/d_link").c_str()), 0);
+
+    os::file::usage_options opt;
+    opt.threads = 2;
+    auto report = os::file::disk_usage(m_dir, opt);
+    EXPECT_EQ(report.total.files, 4u);
+    EXPECT_EQ(report.total.dirs, 4u);
+    EXPECT_EQ(report.total.errors, 0u);
+    EXPECT_GE(report.total.apparent_bytes, 650u);
+    EXPECT_TRUE(report.subdirs.empty());
+
+    opt.count_links_once = false;
+    report = os::file::disk_usage(m_dir, opt);
+    EXPECT_EQ(report.total.files, 5u);
+}
+
+TEST_F(TestDiskUsage, breakdown)
+{
+    os::thread_pool pool(2);
+    os::file::usage_options opt;
+    opt.breakdown = true;
+    opt.pool      = &pool;
+    auto report   = os::file::disk_usage(m_dir, opt);
+
+    ASSERT_EQ(report.subdirs.size(), 2u);
+    EXPECT_EQ(report.subdirs[0].first, "sub1");
+    EXPECT_EQ(report.subdirs[0].second.files, 2u);
+    EXPECT_EQ(report.subdirs[0].second.dirs, 2u);
+    EXPECT_GE(report.subdirs[0].second.apparent_bytes, 500u);
+    EXPECT_EQ(report.subdirs[1].first, "sub2");
+    EXPECT_EQ(report.subdirs[1].second.files, 1u);
+
+    auto sum = report.subdirs[0].second;
+    sum += report.subdirs[1].second;
+    EXPECT_EQ(report.total.files, sum.files + 1); // a sits in the root
+}
+
+#endif
+
+TEST_F(TestDiskUsage, missing)
+{
+    auto report = os::file::disk_usage(m_dir + "/missing");
+    EXPECT_EQ(report.total.errors, 1u);
+    EXPECT_EQ(report.total.files, 0u);
+}
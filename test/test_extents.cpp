@@ -0,0 +1,93 @@
+#include "osal/extents.h"
+#include "osal/os.h"
+#include <gtest/gtest.h>
+#include <string>
+
+class TestExtents : public ::testing::Test {
+public:
+    TestExtents() {}
+
+    ~TestExtents() override {}
+
+    void SetUp() override { os::file::delete_file(m_path); }
+    void TearDown() override { os::file::delete_file(m_path); }
+
+protected:
+    const std::string m_path{"test_extents.dat"};
+};
+
+TEST_F(TestExtents, dump_preallocates)
+{
+    std::string data(1 << 20, 'x');
+    os::file::dump_options opt;
+    opt.preallocate = true;
+    opt.reserve     = 4 << 20;
+    ASSERT_EQ(os::file::dump(m_path, data.data(), data.size(), opt), data.size());
+    EXPECT_EQ(os::file::size(m_path), data.size()); // reserved, not grown
+
+    opt.mode    = "ab";
+    opt.reserve = 0;
+    ASSERT_EQ(os::file::dump(m_path, data.data(), data.size(), opt), data.size());
+    EXPECT_EQ(os::file::size(m_path), 2 * data.size());
+    EXPECT_EQ(os::file::read(m_path).num_bytes, 2 * data.size());
+}
+
+#ifdef __linux__
+
+TEST_F(TestExtents, preallocate)
+{
+    ASSERT_TRUE(os::file::preallocate(m_path, 1 << 20, true));
+    EXPECT_EQ(os::file::size(m_path), 0u);
+    EXPECT_GE(os::file::allocated_size(m_path), uint64_t(1) << 20);
+
+    ASSERT_TRUE(os::file::preallocate(m_path, 2 << 20, false));
+    EXPECT_EQ(os::file::size(m_path), 2u << 20);
+    auto r = os::file::read(m_path);
+    ASSERT_EQ(r.num_bytes, 2u << 20);
+    EXPECT_EQ(std::string(r.data.get(), r.num_bytes).find_first_not_of('\0'), std::string::npos);
+}
+
+TEST_F(TestExtents, punch_hole)
+{
+    const uint64_t mib = 1 << 20;
+    ASSERT_EQ(os::file::dump(m_path, std::string(4 * mib, 'x')), 4 * mib);
+    ASSERT_TRUE(os::file::punch_hole(m_path, mib, 2 * mib));
+    EXPECT_EQ(os::file::size(m_path), 4 * mib);
+    EXPECT_LT(os::file::allocated_size(m_path), 3 * mib);
+
+    auto extents = os::file::data_extents(m_path);
+    ASSERT_EQ(extents.size(), 2u);
+    EXPECT_EQ(extents[0].offset, 0u);
+    EXPECT_EQ(extents[0].size, mib);
+    EXPECT_EQ(extents[1].offset, 3 * mib);
+    EXPECT_EQ(extents[1].size, mib);
+
+    uint64_t bytes = 0, next = 0;
+    bool in_order  = true, only_x = true;
+    EXPECT_TRUE(os::file::for_each_data(m_path, [&](uint64_t offset, os::string_ref data) {
+        in_order = in_order && offset >= next;
+        next     = offset + data.size();
+        bytes += data.size();
+        for (auto c : data)
+            only_x = only_x && c == 'x';
+    }, 300000));
+    EXPECT_EQ(bytes, 2 * mib);
+    EXPECT_TRUE(in_order);
+    EXPECT_TRUE(only_x);
+
+    auto r = os::file::read(m_path);
+    ASSERT_EQ(r.num_bytes, 4 * mib);
+    EXPECT_EQ(r.data[mib], '\0');
+    EXPECT_EQ(r.data[3 * mib - 1], '\0');
+    EXPECT_EQ(r.data[3 * mib], 'x');
+}
+
+#endif
+
+TEST_F(TestExtents, missing)
+{
+    EXPECT_TRUE(os::file::data_extents(m_path).empty());
+    EXPECT_FALSE(os::file::for_each_data(m_path, [](uint64_t, os::string_ref) {}));
+    EXPECT_FALSE(os::file::punch_hole(m_path, 0, 1));
+    EXPECT_EQ(os::file::allocated_size(m_path), 0u);
+}
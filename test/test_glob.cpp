@@ -0,0 +1,100 @@
+#include "osal/glob.h"
+#include "osal/io_metrics.h"
+#include "osal/os.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+class TestGlob : public ::testing::Test {
+public:
+    TestGlob() {}
+
+    ~TestGlob() override {}
+
+    void SetUp() override
+    {
+        os::file::delete_dir(m_dir);
+        for (auto dir : {"", "/logs", "/logs/2025-12", "/logs/2026-01", "/logs/2026-02", "/logs/other", "/logs/.cache"})
+            os::file::create_dir(m_dir + dir);
+        for (auto file : {"/logs/2025-12/app-0.log", "/logs/2026-01/app-1.log", "/logs/2026-01/app-2.log.gz",
+                          "/logs/2026-01/.app-9.log", "/logs/2026-02/app-3.log", "/logs/2026-02/db-1.log",
+                          "/logs/other/x.log", "/logs/.cache/y.log", "/readme.txt"})
+            os::file::touch((m_dir + file).c_str());
+    }
+    void TearDown() override { os::file::delete_dir(m_dir); }
+
+    std::vector<std::string> glob(const std::string& pattern) const { return os::file::glob(m_dir + "/" + pattern); }
+
+    std::string path(const std::string& rel) const { return m_dir + "/" + rel; }
+
+protected:
+    const std::string m_dir{"test_glob"};
+};
+
+TEST_F(TestGlob, match)
+{
+    using os::file::glob_pattern;
+    EXPECT_TRUE(glob_pattern("*.log").match("app.log"));
+    EXPECT_FALSE(glob_pattern("*.log").match("app.log.gz"));
+    EXPECT_FALSE(glob_pattern("*.log").match(".app.log"));
+    EXPECT_TRUE(glob_pattern(".*.log").match(".app.log"));
+    EXPECT_FALSE(glob_pattern("*.log").match("dir/app.log"));
+    EXPECT_TRUE(glob_pattern("a*b*c").match("aXbYbZc"));
+    EXPECT_FALSE(glob_pattern("a*b*c").match("aXbYbZ"));
+    EXPECT_TRUE(glob_pattern("app-?.log").match("app-7.log"));
+    EXPECT_FALSE(glob_pattern("app-?.log").match("app-17.log"));
+    EXPECT_TRUE(glob_pattern("[a-c]x[!0-9]").match("bxz"));
+    EXPECT_FALSE(glob_pattern("[a-c]x[!0-9]").match("bx5"));
+    EXPECT_TRUE(glob_pattern("[]a]").match("]"));
+    EXPECT_TRUE(glob_pattern("[ab").match("[ab"));
+    EXPECT_TRUE(glob_pattern("\\*").match("*"));
+    EXPECT_FALSE(glob_pattern("\\*").match("x"));
+    EXPECT_TRUE(glob_pattern("*.{jpg,png}").match("a.png"));
+    EXPECT_TRUE(glob_pattern("{a,b{1,2}}.txt").match("b2.txt"));
+    EXPECT_FALSE(glob_pattern("{a,b{1,2}}.txt").match("b3.txt"));
+    EXPECT_TRUE(glob_pattern("{a}").match("{a}"));
+    EXPECT_TRUE(glob_pattern("**/*.log").match("x.log"));
+    EXPECT_TRUE(glob_pattern("**/*.log").match("a/b/x.log"));
+    EXPECT_FALSE(glob_pattern("**/*.log").match("a/.b/x.log"));
+    EXPECT_TRUE(glob_pattern("a/**/z").match("a/z"));
+    EXPECT_TRUE(glob_pattern("a/**/z").match("a/b/c/z"));
+    EXPECT_TRUE(glob_pattern("a/**").match("a/b/c"));
+    EXPECT_FALSE(glob_pattern("a/**").match("a"));
+    EXPECT_TRUE(glob_pattern("/var/*").match("/var/log"));
+    EXPECT_FALSE(glob_pattern("/var/*").match("var/log"));
+}
+
+#ifndef _WIN32
+
+TEST_F(TestGlob, walk)
+{
+    EXPECT_EQ(glob("logs/2026-*/app-*.log"), (std::vector<std::string>{path("logs/2026-01/app-1.log"),
+                                                                        path("logs/2026-02/app-3.log")}));
+    EXPECT_EQ(glob("logs/*/app-*.{log,log.gz}").size(), 4u);
+    EXPECT_EQ(glob("logs/**/*.log").size(), 5u); // hidden .cache and .app-9.log are skipped
+    EXPECT_EQ(glob("**/x.log"), (std::vector<std::string>{path("logs/other/x.log")}));
+    EXPECT_EQ(glob("logs/2026-0[2-9]/*"), (std::vector<std::string>{path("logs/2026-02/app-3.log"),
+                                                                     path("logs/2026-02/db-1.log")}));
+    EXPECT_EQ(glob("logs/*/"), (std::vector<std::string>{path("logs/2025-12"), path("logs/2026-01"),
+                                                          path("logs/2026-02"), path("logs/other")}));
+    EXPECT_EQ(glob("readme.txt"), (std::vector<std::string>{path("readme.txt")}));
+    EXPECT_TRUE(glob("missing/*.log").empty());
+    EXPECT_TRUE(glob("readme.txt/*").empty());
+    EXPECT_EQ(glob("{readme.txt,readme.txt}").size(), 1u);
+    EXPECT_EQ(glob("logs/2026-01/**"), (std::vector<std::string>{path("logs/2026-01/app-1.log"),
+                                                                  path("logs/2026-01/app-2.log.gz")}));
+}
+
+TEST_F(TestGlob, literal_prefix_prunes)
+{
+    using os::file::metrics::op;
+    os::file::metrics::reset();
+    EXPECT_EQ(glob("logs/2026-01/app-*").size(), 2u);
+    EXPECT_EQ(os::file::metrics::snapshot()[static_cast<std::size_t>(op::list_dir)].calls, 1u);
+
+    os::file::metrics::reset();
+    EXPECT_EQ(glob("logs/2026-*/app-*.log").size(), 2u);
+    EXPECT_EQ(os::file::metrics::snapshot()[static_cast<std::size_t>(op::list_dir)].calls, 3u);
+}
+
+#endif
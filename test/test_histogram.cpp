@@ -0,0 +1,58 @@
+#include "osal/histogram.h"
+#include <gtest/gtest.h>
+
+class TestHistogram : public ::testing::Test {
+public:
+    TestHistogram() {}
+
+    ~TestHistogram() override {}
+
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(TestHistogram, buckets)
+{
+    for (uint64_t v = 0; v < 8; v++)
+        EXPECT_EQ(os::histogram::bucket_upper(os::histogram::bucket_of(v)), v);
+
+    const unsigned bucket_count = os::histogram::bucket_count;
+
+    // Every value lands in a bucket whose upper bound is within 12.5% above it
+    for (uint64_t v : {8ull, 9ull, 15ull, 16ull, 100ull, 1000ull, 123456789ull, 1ull << 40, ~0ull})
+    {
+        auto b = os::histogram::bucket_of(v);
+        ASSERT_LT(b, bucket_count);
+        EXPECT_GE(os::histogram::bucket_upper(b), v);
+        EXPECT_LE(static_cast<double>(os::histogram::bucket_upper(b)), static_cast<double>(v) * 1.125 + 1);
+        if (b > 0)
+        {
+            EXPECT_LT(os::histogram::bucket_upper(b - 1), v);
+        }
+    }
+}
+
+TEST_F(TestHistogram, percentiles)
+{
+    os::histogram h;
+    EXPECT_EQ(h.percentile(0.5), 0u);
+
+    for (uint64_t v = 1; v <= 1000; v++)
+        h.record(v);
+    EXPECT_EQ(h.count(), 1000u);
+    EXPECT_EQ(h.sum(), 500500u);
+    EXPECT_EQ(h.max(), 1000u);
+    EXPECT_NEAR(static_cast<double>(h.percentile(0.5)), 500.0, 500 * 0.125);
+    EXPECT_NEAR(static_cast<double>(h.percentile(0.99)), 990.0, 990 * 0.125);
+    EXPECT_EQ(h.percentile(1.0), 1000u);
+
+    os::histogram merged;
+    merged.merge(h);
+    merged.merge(h);
+    EXPECT_EQ(merged.count(), 2000u);
+    EXPECT_EQ(merged.max(), 1000u);
+
+    h.reset();
+    EXPECT_EQ(h.count(), 0u);
+    EXPECT_EQ(h.max(), 0u);
+}
@@ -0,0 +1,86 @@
+#include "osal/io_metrics.h"
+#include "osal/os.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+class TestIoMetrics : public ::testing::Test {
+public:
+    TestIoMetrics() {}
+
+    ~TestIoMetrics() override {}
+
+    void SetUp() override { os::file::metrics::reset(); }
+    void TearDown() override { os::file::delete_file("io_metrics.txt"); }
+};
+
+static os::file::metrics::op_report get(os::file::metrics::op o)
+{
+    return os::file::metrics::snapshot()[static_cast<std::size_t>(o)];
+}
+
+TEST_F(TestIoMetrics, counts)
+{
+    using os::file::metrics::op;
+    std::string data(4096, 'x');
+    ASSERT_EQ(os::file::dump("io_metrics.txt", data.data(), data.size()), data.size());
+
+    std::thread reader([]() {
+        for (int i = 0; i < 3; i++)
+            os::file::read("io_metrics.txt");
+    });
+    reader.join(); // the thread's counts must survive its exit
+
+    auto d = get(op::dump);
+    EXPECT_EQ(d.calls, 1u);
+    EXPECT_EQ(d.errors, 0u);
+    EXPECT_EQ(d.bytes, 4096u);
+    EXPECT_GE(d.latency_max_ns, d.latency_p50_ns);
+
+    auto r = get(op::read);
+    EXPECT_EQ(r.calls, 3u);
+    EXPECT_EQ(r.bytes, 3u * 4096u);
+
+    // Every call is counted once, under its own op only
+    EXPECT_EQ(get(op::open).calls, 0u);
+    EXPECT_EQ(get(op::size).calls, 0u);
+
+    os::file::dump_options append;
+    append.mode        = "ab";
+    append.preallocate = true;
+    os::file::dump("io_metrics.txt", data.data(), data.size(), append);
+    os::file::delete_dir("io_metrics_missing");
+    EXPECT_EQ(get(op::dump).calls, 2u);
+    EXPECT_EQ(get(op::delete_dir).calls, 1u);
+    EXPECT_EQ(get(op::size).calls, 0u);
+    EXPECT_EQ(get(op::open).calls, 0u);
+    EXPECT_EQ(get(op::is_dir).calls, 0u);
+
+    os::file::metrics::reset();
+    EXPECT_EQ(get(op::read).calls, 0u);
+    EXPECT_EQ(get(op::read).bytes, 0u);
+}
+
+TEST_F(TestIoMetrics, errors)
+{
+    using os::file::metrics::op;
+    EXPECT_EQ(os::file::read("io_metrics_missing.txt").num_bytes, 0u);
+    EXPECT_EQ(os::file::size("io_metrics_missing.txt"), 0u);
+    EXPECT_TRUE(os::file::list_dir("io_metrics_missing").empty());
+    EXPECT_FALSE(os::file::is_dir("io_metrics_missing"));
+
+    EXPECT_EQ(get(op::read).errors, 1u);
+    EXPECT_EQ(get(op::size).errors, 1u);
+    EXPECT_EQ(get(op::list_dir).errors, 1u);
+    EXPECT_EQ(get(op::is_dir).calls, 1u);
+    EXPECT_EQ(get(op::is_dir).errors, 0u); // a false answer is not a failure
+}
+
+TEST_F(TestIoMetrics, prometheus)
+{
+    os::file::size("io_metrics_missing.txt");
+    auto text = os::file::metrics::prometheus("app_file");
+    EXPECT_NE(text.find("# TYPE app_file_calls_total counter\n"), std::string::npos);
+    EXPECT_NE(text.find("app_file_errors_total{op=\"size\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("app_file_latency_seconds{op=\"size\",quantile=\"0.99\"}"), std::string::npos);
+    EXPECT_NE(text.find("app_file_latency_seconds_count{op=\"size\"} 1\n"), std::string::npos);
+}
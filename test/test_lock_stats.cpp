@@ -0,0 +1,71 @@
+#include "osal/lock_stats.h"
+#include "osal/os.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+class TestLockStats : public ::testing::Test {
+public:
+    TestLockStats() {}
+
+    ~TestLockStats() override {}
+
+    void SetUp() override { os::lock_stats::reset(); }
+    void TearDown() override {}
+};
+
+TEST_F(TestLockStats, report)
+{
+    os::thread_synchronizer hot("test.hot");
+    os::thread_synchronizer cold("test.cold");
+
+    std::thread other([&hot]() {
+        for (int i = 0; i < 100; i++)
+        {
+            if (auto lock = hot.lock())
+                os::sleep_for_ns(10000);
+        }
+    });
+    for (int i = 0; i < 100; i++)
+    {
+        if (auto lock = hot.lock())
+        {
+            os::temporary_unlock unlock(hot);
+        }
+        if (auto lock = cold.lock())
+        {
+        }
+    }
+    other.join();
+
+    auto sites = os::lock_stats::snapshot();
+    auto text  = os::lock_stats::report();
+    if (!os::lock_stats::enabled())
+    {
+        EXPECT_TRUE(sites.empty());
+        EXPECT_NE(text.find("OSAL_LOCK_STATS"), std::string::npos);
+        return;
+    }
+
+    const os::lock_stats::site_report* h = nullptr;
+    const os::lock_stats::site_report* c = nullptr;
+    for (auto& s : sites)
+    {
+        if (s.name == "test.hot")
+            h = &s;
+        if (s.name == "test.cold")
+            c = &s;
+    }
+    ASSERT_NE(h, nullptr);
+    ASSERT_NE(c, nullptr);
+    EXPECT_EQ(h->acquires, 300u); // 200 locks plus 100 temporary_unlock relocks
+    EXPECT_EQ(h->temporary_unlocks, 100u);
+    EXPECT_EQ(c->acquires, 100u);
+    EXPECT_EQ(c->contended, 0u);
+    EXPECT_GE(h->hold_total_ns, 100u * 10000u);
+    EXPECT_GE(h->wait_total_ns, c->wait_total_ns);
+    EXPECT_NE(text.find("test.hot"), std::string::npos);
+
+    os::lock_stats::reset();
+    for (auto& s : os::lock_stats::snapshot())
+        EXPECT_NE(s.name, "test.hot");
+}
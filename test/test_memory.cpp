@@ -0,0 +1,113 @@
+#include "osal/memory.h"
+#include "osal/os.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class TestMemory : public ::testing::Test {
+public:
+    TestMemory() {}
+
+    ~TestMemory() override {}
+
+    void SetUp() override {}
+    void TearDown() override { os::file::delete_file("memory.txt"); }
+};
+
+static bool aligned(const void* p, std::size_t alignment)
+{
+    return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+}
+
+TEST_F(TestMemory, alloc_aligned)
+{
+    auto b = os::memory::alloc_aligned(10000, 4096, os::memory::prefault);
+    ASSERT_TRUE(b);
+    EXPECT_EQ(b.size(), 10000u);
+    EXPECT_TRUE(aligned(b.data(), 4096));
+    std::memset(b.data(), 0xab, b.size());
+
+    EXPECT_FALSE(os::memory::alloc_aligned(64, 3));
+    EXPECT_FALSE(os::memory::alloc_aligned(0));
+
+    os::memory::block moved(std::move(b));
+    EXPECT_FALSE(b);
+    EXPECT_EQ(b.size(), 0u);
+    ASSERT_TRUE(moved);
+    EXPECT_EQ(static_cast<unsigned char>(moved.data()[9999]), 0xab);
+}
+
+namespace {
+struct alignas(128) padded {
+    explicit padded(int& alive)
+        : m_alive(alive)
+    {
+        m_alive++;
+    }
+    ~padded() { m_alive--; }
+    int& m_alive;
+};
+} // namespace
+
+TEST_F(TestMemory, make_aligned)
+{
+    int alive = 0;
+    {
+        std::vector<os::memory::aligned_ptr<padded>> v;
+        for (int i = 0; i < 8; i++)
+        {
+            v.push_back(os::memory::make_aligned<padded>(alive));
+            ASSERT_TRUE(v.back());
+            EXPECT_TRUE(aligned(v.back().get(), 128));
+        }
+        EXPECT_EQ(alive, 8);
+    }
+    EXPECT_EQ(alive, 0);
+}
+
+TEST_F(TestMemory, alloc_huge)
+{
+    auto b = os::memory::alloc_huge(3 << 20, os::memory::prefault);
+    ASSERT_TRUE(b);
+    EXPECT_EQ(b.size(), 3u << 20);
+    EXPECT_TRUE(aligned(b.data(), os::memory::huge_page_size()));
+    std::memset(b.data(), 1, b.size());
+}
+
+TEST_F(TestMemory, alloc_on_node)
+{
+    auto b = os::memory::alloc_on_node(100000, 0, os::memory::prefault);
+    ASSERT_TRUE(b);
+    EXPECT_TRUE(aligned(b.data(), os::memory::page_size()));
+    std::memset(b.data(), 1, b.size());
+
+    EXPECT_FALSE(os::memory::alloc_on_node(4096, 1000));
+}
+
+TEST_F(TestMemory, lock)
+{
+    // Locking may be refused by RLIMIT_MEMLOCK, but then there must be no block
+    auto b = os::memory::alloc_aligned(4096, 4096, os::memory::lock);
+    if (b)
+        std::memset(b.data(), 1, b.size());
+}
+
+TEST_F(TestMemory, read_into_block)
+{
+    std::string data(100000, 'x');
+    ASSERT_EQ(os::file::dump("memory.txt", data), data.size());
+
+    auto r = os::file::read("memory.txt", [](std::size_t n) { return os::memory::alloc_huge(n); });
+    ASSERT_EQ(r.num_bytes, data.size());
+    EXPECT_TRUE(aligned(r.data.get(), os::memory::huge_page_size()));
+    EXPECT_STREQ(r.data.get(), data.c_str());
+
+    auto heap = os::file::read("memory.txt", os::memory::alloc_heap);
+    ASSERT_EQ(heap.num_bytes, data.size());
+    EXPECT_STREQ(heap.data.get(), data.c_str());
+
+    auto failed = os::file::read("memory.txt", [](std::size_t) { return os::memory::block(); });
+    EXPECT_EQ(failed.num_bytes, 0u);
+    EXPECT_EQ(failed.data, nullptr);
+}
@@ -1,6 +1,8 @@
 #include "osal/os.h"
+#include "osal/clock.h"
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
+#include <thread>
 
 class TestOsal : public ::testing::Test {
 public:
@@ -21,6 +23,77 @@ TEST_F(TestOsal, sleep)
     EXPECT_LE(t2, t1 + 2);
 }
 
+TEST_F(TestOsal, sleep_for_ns)
+{
+    auto t1 = os::clock::monotonic_ns();
+    os::sleep_for_ns(os::clock::ms_to_ns(10));
+    auto t2 = os::clock::monotonic_ns();
+    EXPECT_GE(t2 - t1, os::clock::ms_to_ns(10));
+    EXPECT_LT(t2 - t1, os::clock::ms_to_ns(500));
+}
+
+TEST_F(TestOsal, sleep_until_no_drift)
+{
+    auto start = os::clock::monotonic_ns();
+    auto next  = start;
+    for (int i = 0; i < 20; i++)
+    {
+        next += os::clock::ms_to_ns(2);
+        os::sleep_until(next);
+        EXPECT_GE(os::clock::monotonic_ns(), next);
+    }
+    auto elapsed = os::clock::monotonic_ns() - start;
+    EXPECT_GE(elapsed, os::clock::ms_to_ns(40));
+    EXPECT_LT(elapsed, os::clock::ms_to_ns(500));
+
+    // deadline in the past returns immediately
+    os::sleep_until(start);
+}
+
+TEST_F(TestOsal, precise_sleep)
+{
+    auto t1 = os::clock::monotonic_ns();
+    os::precise_sleep(os::clock::ms_to_ns(2));
+    auto t2 = os::clock::monotonic_ns();
+    EXPECT_GE(t2 - t1, os::clock::ms_to_ns(2));
+    EXPECT_LT(t2 - t1, os::clock::ms_to_ns(100));
+
+    auto deadline = os::clock::monotonic_ns() + os::clock::us_to_ns(30);
+    os::precise_sleep_until(deadline);
+    EXPECT_GE(os::clock::monotonic_ns(), deadline);
+}
+
+TEST_F(TestOsal, sleep_interrupted_by_stop)
+{
+    os::thread_synchronizer sync;
+
+    auto t1 = os::clock::monotonic_ns();
+    EXPECT_TRUE(os::sleep(10, sync));
+    EXPECT_GE(os::clock::monotonic_ns() - t1, os::clock::ms_to_ns(10));
+
+    bool full = true;
+    std::thread sleeper([&sync, &full]() { full = os::sleep(5000, sync); });
+    os::sleep(20);
+    auto t2 = os::clock::monotonic_ns();
+    sync.stop();
+    sleeper.join();
+    EXPECT_FALSE(full);
+    EXPECT_LT(os::clock::monotonic_ns() - t2, os::clock::ms_to_ns(1000));
+
+    // already stopped
+    EXPECT_FALSE(os::sleep_for_ns(os::clock::s_to_ns(5), sync));
+    sync.resume();
+    EXPECT_TRUE(os::sleep_until(os::clock::monotonic_ns() + os::clock::ms_to_ns(1), sync));
+
+    // a timeout past the end of the clock saturates instead of wrapping into the past
+    std::thread forever([&sync, &full]() { full = os::sleep_for_ns(UINT64_MAX, sync); });
+    os::sleep(20);
+    sync.stop();
+    forever.join();
+    EXPECT_FALSE(full);
+    EXPECT_EQ(os::clock::deadline_after(10, UINT64_MAX - 5), UINT64_MAX);
+}
+
 TEST_F(TestOsal, dump_and_read_nominal)
 {
     std::string data("Hope you have a good day");
@@ -0,0 +1,76 @@
+#include "osal/page_cache.h"
+#include "osal/os.h"
+#include <gtest/gtest.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestPageCache : public ::testing::Test {
+public:
+    TestPageCache() {}
+
+    ~TestPageCache() override {}
+
+    void SetUp() override { os::file::dump(m_path, std::string(m_size, 'p')); }
+    void TearDown() override { os::file::delete_file(m_path); }
+
+protected:
+    const std::string m_path{"test_page_cache.dat"};
+    const std::size_t m_size{1 << 20};
+};
+
+#ifdef __linux__
+
+TEST_F(TestPageCache, evict_and_prefetch)
+{
+    auto r = os::file::residency(m_path);
+    EXPECT_EQ(r.total_pages, (m_size + r.page_size - 1) / r.page_size);
+    EXPECT_EQ(r.resident_pages, r.total_pages); // just written
+
+    ASSERT_TRUE(os::file::evict(m_path));
+    EXPECT_LT(os::file::residency(m_path).resident_pages, r.total_pages);
+
+    ASSERT_TRUE(os::file::advise(m_path, os::file::access::willneed));
+    // The reads are queued, give them a moment to land
+    for (int i = 0; i < 200 && os::file::residency(m_path).resident_pages < r.total_pages; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_DOUBLE_EQ(os::file::residency(m_path).ratio(), 1.0);
+
+    EXPECT_EQ(os::file::read(m_path).num_bytes, m_size); // hints never change the data
+}
+
+TEST_F(TestPageCache, hints)
+{
+    using os::file::access;
+    for (auto hint : {access::normal, access::sequential, access::random, access::noreuse})
+        EXPECT_TRUE(os::file::advise(m_path, hint, os::file::extent{4096, 8192}));
+
+    auto fd = os::file::open(m_path, "rb");
+    ASSERT_NE(fd, nullptr);
+    EXPECT_TRUE(os::file::advise(fd, access::sequential));
+    os::file::close(fd);
+
+    // Still buffered output is written back and dropped as well, not left dirty by the close
+    fd = os::file::open(m_path, "wb");
+    ASSERT_NE(fd, nullptr);
+    ASSERT_EQ(fwrite("buffered", 1, 8, fd), 8u);
+    EXPECT_TRUE(os::file::advise(fd, access::dontneed));
+    os::file::close(fd);
+    EXPECT_EQ(os::file::size(m_path), 8u);
+    EXPECT_EQ(os::file::residency(m_path).resident_pages, 0u);
+
+    std::vector<char> buf(3 * 4096, 'b');
+    EXPECT_TRUE(os::file::advise(buf.data() + 1, buf.size() - 1, access::sequential));
+    EXPECT_TRUE(os::file::advise(buf.data(), buf.size(), access::normal));
+    EXPECT_FALSE(os::file::advise(buf.data(), buf.size(), access::noreuse));
+}
+
+#endif
+
+TEST_F(TestPageCache, missing)
+{
+    EXPECT_FALSE(os::file::advise("test_page_cache_missing", os::file::access::willneed));
+    EXPECT_FALSE(os::file::evict("test_page_cache_missing"));
+    EXPECT_EQ(os::file::residency("test_page_cache_missing").total_pages, 0u);
+}
@@ -0,0 +1,134 @@
+#include "osal/queue.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestQueue : public ::testing::Test {
+public:
+    TestQueue() {}
+
+    ~TestQueue() override {}
+
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(TestQueue, spsc_nominal)
+{
+    os::spsc_queue<std::string> q(3);
+    EXPECT_EQ(q.capacity(), 4);
+    EXPECT_TRUE(q.empty());
+
+    EXPECT_TRUE(q.try_push("a"));
+    EXPECT_TRUE(q.try_push(std::string("b")));
+    EXPECT_TRUE(q.try_push("c"));
+    EXPECT_TRUE(q.try_push("d"));
+    EXPECT_FALSE(q.try_push("e"));
+    EXPECT_EQ(q.size(), 4);
+
+    std::string s;
+    EXPECT_TRUE(q.try_pop(s));
+    EXPECT_EQ(s, "a");
+
+    std::string out[8];
+    EXPECT_EQ(q.try_pop(out, 8), 3);
+    EXPECT_EQ(out[0], "b");
+    EXPECT_EQ(out[2], "d");
+    EXPECT_FALSE(q.try_pop(s));
+
+    std::string in[] = {"1", "2", "3", "4", "5"};
+    EXPECT_EQ(q.try_push(in, 5), 4);
+    EXPECT_EQ(q.size(), 4);
+}
+
+TEST_F(TestQueue, spsc_threads)
+{
+    os::spsc_queue<int> q(64, true);
+    const int count = 100000;
+
+    std::thread producer([&q]() {
+        for (int i = 0; i < count; i++)
+        {
+            while (!q.try_push(i))
+                std::this_thread::yield();
+        }
+    });
+
+    int v = 0;
+    for (int i = 0; i < count; i++)
+    {
+        ASSERT_TRUE(q.pop_wait(v));
+        ASSERT_EQ(v, i);
+    }
+    producer.join();
+    EXPECT_FALSE(q.pop_wait(v, 1000000));
+}
+
+TEST_F(TestQueue, mpmc_nominal)
+{
+    os::mpmc_queue<int> q(4);
+    int in[] = {1, 2, 3, 4, 5, 6};
+    EXPECT_EQ(q.try_push(in, 6), 4);
+    EXPECT_FALSE(q.try_push(7));
+
+    int out[6] = {};
+    EXPECT_EQ(q.try_pop(out, 3), 3);
+    EXPECT_EQ(out[0], 1);
+    EXPECT_EQ(out[2], 3);
+    EXPECT_TRUE(q.try_push(7));
+
+    int v = 0;
+    EXPECT_TRUE(q.try_pop(v));
+    EXPECT_EQ(v, 4);
+    EXPECT_TRUE(q.try_pop(v));
+    EXPECT_EQ(v, 7);
+    EXPECT_FALSE(q.try_pop(v));
+}
+
+TEST_F(TestQueue, mpmc_threads)
+{
+    os::mpmc_queue<int> q(128, true);
+    const int producers = 4;
+    const int consumers = 4;
+    const int per_producer = 20000;
+    std::atomic<long long> sum{0};
+    std::atomic<int> popped{0};
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++)
+    {
+        threads.emplace_back([&q, p]() {
+            int batch[8];
+            for (int i = 0; i < per_producer; i += 8)
+            {
+                for (int j = 0; j < 8; j++)
+                    batch[j] = p * per_producer + i + j;
+                std::size_t pushed = 0;
+                while (pushed < 8)
+                    pushed += q.try_push(batch + pushed, 8 - pushed);
+            }
+        });
+    }
+    for (int c = 0; c < consumers; c++)
+    {
+        threads.emplace_back([&q, &sum, &popped]() {
+            int v;
+            while (popped.load() < producers * per_producer)
+            {
+                if (q.pop_wait(v, 1000000))
+                {
+                    sum += v;
+                    popped++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads)
+        t.join();
+
+    long long n = producers * per_producer;
+    EXPECT_EQ(popped.load(), n);
+    EXPECT_EQ(sum.load(), n * (n - 1) / 2);
+}
@@ -0,0 +1,81 @@
+#include "osal/os.h"
+#include "osal/stat_cache.h"
+#include <gtest/gtest.h>
+#include <string>
+
+class TestStatCache : public ::testing::Test {
+public:
+    TestStatCache() {}
+
+    ~TestStatCache() override {}
+
+    void SetUp() override
+    {
+        os::file::delete_dir(m_dir);
+        os::file::create_dir(m_dir);
+    }
+    void TearDown() override { os::file::delete_dir(m_dir); }
+
+protected:
+    const std::string m_dir{"./test_stat_cache"};
+};
+
+TEST_F(TestStatCache, answers_like_uncached)
+{
+    os::file::stat_cache cache;
+    auto file = m_dir + "/a.txt";
+    EXPECT_EQ(os::file::dump(file, std::string("12345")), 5u);
+
+    EXPECT_TRUE(cache.is_reg_file(file));
+    EXPECT_FALSE(cache.is_dir(file));
+    EXPECT_EQ(cache.size(file), 5u);
+    EXPECT_TRUE(cache.is_dir(m_dir));
+    EXPECT_FALSE(cache.is_reg_file(m_dir));
+    EXPECT_FALSE(cache.is_reg_file(m_dir + "/missing"));
+    EXPECT_FALSE(cache.is_dir(m_dir + "/missing"));
+
+    EXPECT_EQ(cache.misses(), 3u);
+    EXPECT_EQ(cache.hits(), 4u);
+    EXPECT_EQ(cache.entries(), 3u);
+}
+
+TEST_F(TestStatCache, ttl_and_invalidate)
+{
+    os::file::stat_cache cache(os::clock::ms_to_ns(50));
+    auto file = m_dir + "/b.txt";
+    EXPECT_FALSE(cache.is_reg_file(file));
+
+    EXPECT_TRUE(os::file::touch(file.c_str()));
+    EXPECT_FALSE(cache.is_reg_file(file)); // still cached
+    os::sleep(60);
+    EXPECT_TRUE(cache.is_reg_file(file));
+
+    EXPECT_EQ(os::file::dump(file, std::string("xy")), 2u);
+    EXPECT_EQ(cache.size(file), 0u);
+    cache.invalidate(file);
+    EXPECT_EQ(cache.size(file), 2u);
+
+    cache.invalidate_below(m_dir);
+    EXPECT_EQ(cache.entries(), 0u);
+}
+
+#ifdef __linux__
+TEST_F(TestStatCache, watch_invalidates)
+{
+    os::file::stat_cache cache(0);
+    ASSERT_TRUE(cache.watch(m_dir));
+    auto file = m_dir + "/c.txt";
+    EXPECT_FALSE(cache.is_reg_file(file));
+
+    EXPECT_TRUE(os::file::touch(file.c_str()));
+    auto deadline = os::clock::monotonic_ns() + os::clock::s_to_ns(5);
+    while (!cache.is_reg_file(file) && os::clock::monotonic_ns() < deadline)
+        os::sleep(1);
+    EXPECT_TRUE(cache.is_reg_file(file));
+
+    EXPECT_TRUE(os::file::delete_file(file));
+    while (cache.is_reg_file(file) && os::clock::monotonic_ns() < deadline)
+        os::sleep(1);
+    EXPECT_FALSE(cache.is_reg_file(file));
+}
+#endif
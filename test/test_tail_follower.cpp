@@ -0,0 +1,137 @@
+#include "osal/os.h"
+#include "osal/tail_follower.h"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class TestTailFollower : public ::testing::Test {
+public:
+    TestTailFollower() {}
+
+    ~TestTailFollower() override {}
+
+    void SetUp() override
+    {
+        os::file::delete_dir(m_dir);
+        os::file::create_dir(m_dir);
+    }
+    void TearDown() override { os::file::delete_dir(m_dir); }
+
+    os::file::tail_follower::callback collect()
+    {
+        return [this](os::string_ref record) {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            m_records.push_back(record.str());
+        };
+    }
+
+    std::vector<std::string> records()
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        return m_records;
+    }
+
+protected:
+    const std::string m_dir{"./test_tail_follower"};
+    const std::string m_log{"./test_tail_follower/app.log"};
+    std::mutex m_mtx;
+    std::vector<std::string> m_records;
+};
+
+#ifndef _WIN32
+
+TEST_F(TestTailFollower, appended_records)
+{
+    os::file::dump(m_log, std::string("a\nb\npar"));
+    os::file::tail_follower tail(m_log, collect());
+    EXPECT_TRUE(tail.is_open());
+    EXPECT_EQ(tail.poll(), 2u);
+    EXPECT_EQ(tail.poll(), 0u);
+
+    os::file::dump(m_log, std::string("tial\nc\n"), "ab");
+    EXPECT_EQ(tail.poll(), 2u);
+    EXPECT_EQ(records(), (std::vector<std::string>{"a", "b", "partial", "c"}));
+    EXPECT_EQ(tail.offset(), 14u);
+}
+
+TEST_F(TestTailFollower, from_end_and_delimiter)
+{
+    os::file::dump(m_log, std::string("old;old;"));
+    os::file::tail_follower tail(m_log, collect(), os::file::tail_follower::from_end, ';');
+    EXPECT_EQ(tail.poll(), 0u);
+
+    os::file::dump(m_log, std::string("new;"), "ab");
+    EXPECT_EQ(tail.poll(), 1u);
+    EXPECT_EQ(records(), std::vector<std::string>{"new"});
+}
+
+TEST_F(TestTailFollower, missing_then_created)
+{
+    os::file::tail_follower tail(m_log, collect(), os::file::tail_follower::from_end);
+    EXPECT_FALSE(tail.is_open());
+    EXPECT_EQ(tail.poll(), 0u);
+
+    os::file::dump(m_log, std::string("first\n"));
+    EXPECT_EQ(tail.poll(), 1u);
+    EXPECT_TRUE(tail.is_open());
+}
+
+TEST_F(TestTailFollower, truncation)
+{
+    os::file::dump(m_log, std::string("line one\nline two\n"));
+    os::file::tail_follower tail(m_log, collect());
+    EXPECT_EQ(tail.poll(), 2u);
+
+    os::file::dump(m_log, std::string("x\n"));
+    EXPECT_EQ(tail.poll(), 1u);
+    EXPECT_EQ(tail.truncations(), 1u);
+    EXPECT_EQ(records().back(), "x");
+
+    // An unfinished record is not lost when the file is cut
+    os::file::dump(m_log, std::string("a longer line, unfinished"), "ab");
+    EXPECT_EQ(tail.poll(), 0u);
+    os::file::dump(m_log, std::string("y\n"));
+    EXPECT_EQ(tail.poll(), 2u);
+    EXPECT_EQ(tail.truncations(), 2u);
+    ASSERT_EQ(records().size(), 5u);
+    EXPECT_EQ(records()[3], "a longer line, unfinished");
+    EXPECT_EQ(records()[4], "y");
+}
+
+TEST_F(TestTailFollower, rotation)
+{
+    os::file::dump(m_log, std::string("before\nunfinished"));
+    os::file::tail_follower tail(m_log, collect());
+    EXPECT_EQ(tail.poll(), 1u);
+
+    os::file::dump(m_log, std::string(" line\n"), "ab");
+    EXPECT_EQ(std::rename(m_log.c_str(), (m_log + ".1").c_str()), 0);
+    os::file::dump(m_log, std::string("after\n"));
+
+    EXPECT_EQ(tail.poll(), 2u);
+    EXPECT_EQ(tail.rotations(), 1u);
+    EXPECT_EQ(records(), (std::vector<std::string>{"before", "unfinished line", "after"}));
+}
+
+TEST_F(TestTailFollower, follow)
+{
+    os::file::dump(m_log, std::string(""));
+    os::file::tail_follower tail(m_log, collect());
+    std::thread t([&tail]() { tail.follow(); });
+
+    for (int i = 0; i < 10; i++)
+        os::file::dump(m_log, std::to_string(i) + "\n", "ab");
+
+    auto deadline = os::clock::monotonic_ns() + os::clock::s_to_ns(5);
+    while (records().size() < 10 && os::clock::monotonic_ns() < deadline)
+        os::sleep(1);
+    tail.stop();
+    t.join();
+    EXPECT_EQ(records().size(), 10u);
+    EXPECT_EQ(records().back(), "9");
+}
+
+#endif
@@ -0,0 +1,152 @@
+#include "osal/cpu_features.h"
+#include "osal/text.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+class TestText : public ::testing::Test {
+public:
+    TestText() {}
+
+    ~TestText() override {}
+
+    void SetUp() override {}
+    void TearDown() override {}
+
+    /// Feeds @p input in chunks of @p chunk bytes and collects the records
+    static std::vector<std::string> split(const std::string& input, std::size_t chunk)
+    {
+        std::vector<std::string> out;
+        os::text::line_splitter lines;
+        os::string_ref line;
+        for (std::size_t i = 0; i < input.size(); i += chunk)
+        {
+            lines.feed(os::string_ref(input.data() + i, std::min(chunk, input.size() - i)));
+            while (lines.next(line))
+                out.push_back(line.str());
+        }
+        while (lines.finish(line))
+            out.push_back(line.str());
+        return out;
+    }
+};
+
+TEST_F(TestText, find_byte_every_tier)
+{
+    std::vector<char> buf(300, 'x');
+    for (int tier = 0; tier <= static_cast<int>(os::host_tier()); tier++)
+    {
+        os::force_tier(static_cast<os::simd_tier>(tier));
+        for (std::size_t offset = 0; offset < 40; offset++)
+        {
+            for (std::size_t len = 0; len + offset <= buf.size(); len += 7)
+            {
+                auto begin = buf.data() + offset;
+                auto end   = begin + len;
+                EXPECT_EQ(os::text::find_byte(begin, end, '\n'), end);
+                for (std::size_t at = 0; at < len; at += 13)
+                {
+                    begin[at] = '\n';
+                    EXPECT_EQ(os::text::find_byte(begin, end, '\n'), begin + at) << os::tier_name(os::active_tier());
+                    begin[at] = 'x';
+                }
+            }
+        }
+    }
+    os::clear_forced_tier();
+}
+
+TEST_F(TestText, line_splitter)
+{
+    std::string input = "first\n\nthird line\na much longer line that spans more than one vector width\nlast";
+    std::vector<std::string> expected = {"first", "", "third line",
+                                         "a much longer line that spans more than one vector width", "last"};
+    for (std::size_t chunk = 1; chunk <= input.size(); chunk++)
+        EXPECT_EQ(split(input, chunk), expected) << "chunk " << chunk;
+
+    EXPECT_EQ(split("a\nb\n", 4), (std::vector<std::string>{"a", "b"}));
+    EXPECT_TRUE(split("", 1).empty());
+}
+
+TEST_F(TestText, record_splitter)
+{
+    std::string input;
+    std::vector<std::string> expected = {"", "one", std::string(300, 'r'), "two"};
+    for (auto& r : expected)
+    {
+        uint16_t n = static_cast<uint16_t>(r.size());
+        input.push_back(static_cast<char>(n >> 8));
+        input.push_back(static_cast<char>(n & 0xff));
+        input += r;
+    }
+
+    for (std::size_t chunk = 1; chunk <= input.size(); chunk += 5)
+    {
+        os::text::record_splitter records(2, true);
+        std::vector<std::string> out;
+        os::string_ref record;
+        for (std::size_t i = 0; i < input.size(); i += chunk)
+        {
+            records.feed(os::string_ref(input.data() + i, std::min(chunk, input.size() - i)));
+            while (records.next(record))
+                out.push_back(record.str());
+        }
+        EXPECT_EQ(out, expected) << "chunk " << chunk;
+        EXPECT_FALSE(records.truncated());
+    }
+
+    os::text::record_splitter records(4);
+    const char partial[] = {5, 0, 0, 0, 'a', 'b'};
+    records.feed(os::string_ref(partial, sizeof(partial)));
+    os::string_ref record;
+    EXPECT_FALSE(records.next(record));
+    EXPECT_TRUE(records.truncated());
+    EXPECT_EQ(records.carried(), 6u);
+}
+
+TEST_F(TestText, line_splitter_max_record)
+{
+    std::string input = "ok\n" + std::string(100, 'x') + "\nfine\n" + std::string(100, 'y');
+    for (std::size_t chunk = 1; chunk <= input.size(); chunk += 7)
+    {
+        os::text::line_splitter lines('\n', 10);
+        std::vector<std::string> out;
+        os::string_ref line;
+        for (std::size_t i = 0; i < input.size(); i += chunk)
+        {
+            lines.feed(os::string_ref(input.data() + i, std::min(chunk, input.size() - i)));
+            while (lines.next(line))
+                out.push_back(line.str());
+            EXPECT_LE(lines.carried(), 10u);
+        }
+        EXPECT_FALSE(lines.finish(line));
+        EXPECT_EQ(out, (std::vector<std::string>{"ok", "fine"})) << "chunk " << chunk;
+        EXPECT_EQ(lines.oversized(), 2u);
+    }
+}
+
+TEST_F(TestText, record_splitter_max_record)
+{
+    os::string_ref record;
+    const char big[] = {3, 'a', 'b', 'c', 100, 'd'};
+    os::text::record_splitter records(1, false, 10);
+    records.feed(os::string_ref(big, sizeof(big)));
+    EXPECT_TRUE(records.next(record));
+    EXPECT_EQ(record.str(), "abc");
+    EXPECT_FALSE(records.next(record));
+    EXPECT_TRUE(records.overflowed());
+    EXPECT_EQ(records.carried(), 0u);
+    records.feed(os::string_ref(big, sizeof(big)));
+    EXPECT_FALSE(records.next(record)); // no way to find the next record
+
+    // A length that would wrap prefix + body around is rejected, even byte by byte
+    const char hostile[] = {-1, -1, -1, -1, -1, -1, -1, -1, 'z'};
+    os::text::record_splitter wide(8, false, SIZE_MAX);
+    for (auto c : hostile)
+    {
+        wide.feed(os::string_ref(&c, 1));
+        EXPECT_FALSE(wide.next(record));
+    }
+    EXPECT_TRUE(wide.overflowed());
+}
@@ -0,0 +1,80 @@
+#include "osal/thread.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+
+class TestThread : public ::testing::Test {
+public:
+    TestThread() {}
+
+    ~TestThread() override {}
+
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(TestThread, cpus)
+{
+    auto online = os::online_cpus();
+    ASSERT_FALSE(online.empty());
+    EXPECT_TRUE(std::is_sorted(online.begin(), online.end()));
+    EXPECT_GE(os::cpu_count(), 1u);
+    EXPECT_LE(os::cpu_count(), online.size());
+
+    for (auto c : os::this_thread::affinity())
+        EXPECT_NE(std::find(online.begin(), online.end(), c), online.end());
+}
+
+TEST_F(TestThread, pin)
+{
+    auto allowed = os::this_thread::affinity();
+    ASSERT_FALSE(allowed.empty());
+
+    // On a separate thread so the test runner keeps its affinity
+    std::thread t([&allowed]() {
+        ASSERT_TRUE(os::this_thread::pin(allowed.back()));
+        auto now = os::this_thread::affinity();
+        ASSERT_EQ(now.size(), 1u);
+        EXPECT_EQ(now[0], allowed.back());
+
+        EXPECT_TRUE(os::this_thread::set_affinity(allowed));
+        EXPECT_EQ(os::this_thread::affinity(), allowed);
+    });
+    t.join();
+}
+
+TEST_F(TestThread, name)
+{
+    std::thread t([]() {
+        ASSERT_TRUE(os::this_thread::set_name("osal-worker"));
+        EXPECT_EQ(os::this_thread::name(), "osal-worker");
+        ASSERT_TRUE(os::this_thread::set_name("a-name-longer-than-fifteen-characters"));
+        EXPECT_EQ(os::this_thread::name().find("a-name"), 0u);
+    });
+    t.join();
+}
+
+TEST_F(TestThread, scheduling)
+{
+    std::thread t([]() {
+        EXPECT_EQ(os::this_thread::scheduling_policy(), os::this_thread::sched_policy::other);
+        EXPECT_TRUE(os::this_thread::set_scheduling(os::this_thread::sched_policy::other));
+
+        // Raising niceness never needs privileges
+        auto before = os::this_thread::nice();
+        ASSERT_TRUE(os::this_thread::set_nice(std::min(before + 1, 19)));
+        EXPECT_EQ(os::this_thread::nice(), std::min(before + 1, 19));
+
+        // Real time usually needs privileges, it must either work or report failure
+        if (os::this_thread::set_scheduling(os::this_thread::sched_policy::fifo, 1))
+        {
+            EXPECT_EQ(os::this_thread::scheduling_policy(), os::this_thread::sched_policy::fifo);
+            EXPECT_EQ(os::this_thread::scheduling_priority(), 1);
+        }
+        else
+        {
+            EXPECT_EQ(os::this_thread::scheduling_policy(), os::this_thread::sched_policy::other);
+        }
+    });
+    t.join();
+}
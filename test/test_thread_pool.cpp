@@ -0,0 +1,113 @@
+#include "osal/thread_pool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+class TestThreadPool : public ::testing::Test {
+public:
+    TestThreadPool() {}
+
+    ~TestThreadPool() override {}
+
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(TestThreadPool, submit)
+{
+    os::thread_pool pool(4);
+    EXPECT_EQ(pool.size(), 4);
+
+    auto f = pool.submit([](int x) { return x * 2; }, 21);
+    ASSERT_TRUE(f.valid());
+    EXPECT_EQ(f.get(), 42);
+}
+
+TEST_F(TestThreadPool, submit_from_task)
+{
+    os::thread_pool pool(2);
+    std::atomic<int> count{0};
+
+    auto f = pool.submit([&pool, &count]() {
+        std::vector<std::future<void>> inner;
+        for (int i = 0; i < 100; i++)
+            inner.push_back(pool.submit([&count]() { count++; }));
+        for (auto& i : inner)
+            i.wait();
+    });
+    f.wait();
+    EXPECT_EQ(count.load(), 100);
+}
+
+TEST_F(TestThreadPool, parallel_for)
+{
+    os::thread_pool pool(4);
+    std::vector<int> v(10000, 0);
+
+    pool.parallel_for(0, v.size(), [&v](std::size_t i) { v[i] = static_cast<int>(i); });
+    for (std::size_t i = 0; i < v.size(); i++)
+        ASSERT_EQ(v[i], static_cast<int>(i));
+
+    // nested inside a task
+    std::atomic<int> count{0};
+    pool.submit([&pool, &count]() {
+        pool.parallel_for(0, 1000, [&count](std::size_t) { count++; }, 7);
+    }).wait();
+    EXPECT_EQ(count.load(), 1000);
+}
+
+TEST_F(TestThreadPool, shutdown_drains)
+{
+    std::atomic<int> count{0};
+    {
+        os::thread_pool pool(1);
+        for (int i = 0; i < 1000; i++)
+            pool.post([&count]() { count++; });
+    }
+    EXPECT_EQ(count.load(), 1000);
+}
+
+TEST_F(TestThreadPool, shutdown_races_post)
+{
+    // Every post() that returns true must run, even when shutdown() lands in between
+    for (int round = 0; round < 500; round++)
+    {
+        std::atomic<int> accepted{0}, executed{0};
+        std::atomic<bool> go{false};
+        os::thread_pool pool(2);
+        std::vector<std::thread> posters;
+        for (int p = 0; p < 4; p++)
+        {
+            posters.emplace_back([&]() {
+                while (!go.load())
+                {
+                }
+                // Spaced out, so workers keep going idle and re-checking the stop flag
+                while (pool.post([&executed]() { executed++; }))
+                {
+                    accepted++;
+                    std::this_thread::yield();
+                }
+            });
+        }
+        go = true;
+        std::this_thread::yield();
+        pool.shutdown();
+        for (auto& t : posters)
+            t.join();
+        EXPECT_EQ(executed.load(), accepted.load()) << "round " << round;
+    }
+}
+
+TEST_F(TestThreadPool, synchronizer_stop)
+{
+    os::thread_synchronizer sync;
+    os::thread_pool pool(sync, 2);
+
+    EXPECT_TRUE(pool.submit([]() {}).valid());
+    sync.stop();
+    EXPECT_TRUE(pool.stopping());
+    EXPECT_FALSE(pool.submit([]() {}).valid());
+    EXPECT_FALSE(pool.post([]() {}));
+}
@@ -0,0 +1,103 @@
+#include "osal/thread_pool.h"
+#include "osal/timer_service.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <vector>
+
+class TestTimerService : public ::testing::Test {
+public:
+    TestTimerService() {}
+
+    ~TestTimerService() override {}
+
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(TestTimerService, one_shot)
+{
+    os::timer_service timers;
+    std::atomic<uint64_t> fired_at{0};
+
+    auto start = os::clock::monotonic_ns();
+    auto id = timers.schedule(os::clock::ms_to_ns(20), [&fired_at]() { fired_at = os::clock::monotonic_ns(); });
+    EXPECT_NE(id, 0u);
+    EXPECT_EQ(timers.size(), 1u);
+
+    while (fired_at.load() == 0 && os::clock::monotonic_ns() - start < os::clock::s_to_ns(5))
+        os::sleep(1);
+    EXPECT_GE(fired_at.load() - start, os::clock::ms_to_ns(20));
+    EXPECT_LT(fired_at.load() - start, os::clock::ms_to_ns(1000));
+    EXPECT_EQ(timers.size(), 0u);
+    EXPECT_FALSE(timers.cancel(id));
+}
+
+TEST_F(TestTimerService, cancel)
+{
+    os::timer_service timers;
+    std::atomic<int> fired{0};
+
+    std::vector<os::timer_service::timer_id> ids;
+    for (int i = 0; i < 10000; i++)
+        ids.push_back(timers.schedule(os::clock::ms_to_ns(200 + i % 300), [&fired]() { fired++; }));
+    EXPECT_EQ(timers.size(), 10000u);
+
+    for (std::size_t i = 0; i < ids.size(); i += 2)
+        EXPECT_TRUE(timers.cancel(ids[i]));
+    EXPECT_FALSE(timers.cancel(ids[0]));
+    EXPECT_FALSE(timers.cancel(0));
+    EXPECT_EQ(timers.size(), 5000u);
+
+    auto start = os::clock::monotonic_ns();
+    while (fired.load() < 5000 && os::clock::monotonic_ns() - start < os::clock::s_to_ns(10))
+        os::sleep(5);
+    os::sleep(20);
+    EXPECT_EQ(fired.load(), 5000);
+    EXPECT_EQ(timers.size(), 0u);
+}
+
+TEST_F(TestTimerService, long_delay_cascades)
+{
+    // 100 us ticks push a 60 ms timer through the second wheel level
+    os::timer_service timers(os::clock::us_to_ns(100));
+    std::atomic<uint64_t> fired_at{0};
+
+    auto start = os::clock::monotonic_ns();
+    timers.schedule(os::clock::ms_to_ns(60), [&fired_at]() { fired_at = os::clock::monotonic_ns(); });
+    while (fired_at.load() == 0 && os::clock::monotonic_ns() - start < os::clock::s_to_ns(5))
+        os::sleep(1);
+    EXPECT_GE(fired_at.load() - start, os::clock::ms_to_ns(60));
+    EXPECT_LT(fired_at.load() - start, os::clock::ms_to_ns(1000));
+}
+
+TEST_F(TestTimerService, periodic)
+{
+    os::timer_service timers;
+    std::atomic<int> fired{0};
+
+    auto id = timers.schedule_periodic(os::clock::ms_to_ns(5), [&fired]() { fired++; });
+    os::sleep(100);
+    EXPECT_TRUE(timers.cancel(id));
+    auto count = fired.load();
+    EXPECT_GE(count, 5);
+    EXPECT_LE(count, 21);
+
+    os::sleep(20);
+    EXPECT_EQ(fired.load(), count);
+    EXPECT_EQ(timers.size(), 0u);
+}
+
+TEST_F(TestTimerService, pool_dispatch)
+{
+    os::thread_pool pool(2);
+    os::timer_service timers(pool);
+    std::atomic<int> fired{0};
+
+    for (int i = 0; i < 100; i++)
+        timers.schedule(os::clock::ms_to_ns(i % 10), [&fired]() { fired++; });
+
+    auto start = os::clock::monotonic_ns();
+    while (fired.load() < 100 && os::clock::monotonic_ns() - start < os::clock::s_to_ns(5))
+        os::sleep(1);
+    EXPECT_EQ(fired.load(), 100);
+}
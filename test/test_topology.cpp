@@ -0,0 +1,69 @@
+#include "osal/thread.h"
+#include "osal/topology.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+
+class TestTopology : public ::testing::Test {
+public:
+    TestTopology() {}
+
+    ~TestTopology() override {}
+
+    void SetUp() override {}
+    void TearDown() override {}
+};
+
+TEST_F(TestTopology, machine)
+{
+    auto& m = os::topology::get();
+    EXPECT_EQ(&m, &os::topology::get()); // cached
+
+    ASSERT_EQ(m.cpus.size(), os::online_cpus().size());
+    EXPECT_GE(m.cores, 1u);
+    EXPECT_LE(m.cores, m.cpus.size());
+    EXPECT_GE(m.packages, 1u);
+    EXPECT_GE(m.nodes, 1u);
+    for (auto& c : m.cpus)
+    {
+        EXPECT_LT(c.core, m.cores);
+        EXPECT_LT(c.package, m.packages);
+    }
+    for (auto& k : m.caches)
+    {
+        EXPECT_GE(k.level, 1u);
+        EXPECT_FALSE(k.shared_cpus.empty());
+        EXPECT_TRUE(std::is_sorted(k.shared_cpus.begin(), k.shared_cpus.end()));
+    }
+}
+
+TEST_F(TestTopology, queries)
+{
+    auto line = os::topology::cache_line_size();
+    EXPECT_GE(line, 16u);
+    EXPECT_EQ(line & (line - 1), 0u);
+
+    for (auto cpu : os::online_cpus())
+    {
+        auto siblings = os::topology::smt_siblings(cpu);
+        EXPECT_NE(std::find(siblings.begin(), siblings.end(), cpu), siblings.end());
+
+        auto node  = os::topology::node_of(cpu);
+        auto local = os::topology::cpus_of_node(node);
+        EXPECT_NE(std::find(local.begin(), local.end(), cpu), local.end());
+
+        // Whoever shares a core also shares its L1
+        auto l1 = os::topology::sharing_cache(cpu, 1);
+        if (!l1.empty())
+        {
+            for (auto s : siblings)
+                EXPECT_NE(std::find(l1.begin(), l1.end(), s), l1.end());
+        }
+    }
+
+    EXPECT_TRUE(os::topology::smt_siblings(~0u).empty());
+    EXPECT_TRUE(os::topology::sharing_cache(0, 9).empty());
+    if (os::topology::cache_size(1) && os::topology::cache_size(2))
+    {
+        EXPECT_LE(os::topology::cache_size(1), os::topology::cache_size(2));
+    }
+}
@@ -0,0 +1,71 @@
+#include "osal/os.h"
+#include "osal/trace.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+class TestTrace : public ::testing::Test {
+public:
+    TestTrace() {}
+
+    ~TestTrace() override {}
+
+    void SetUp() override { os::trace::reset(); }
+    void TearDown() override { os::file::delete_file("trace.json"); }
+};
+
+static std::size_t occurrences(const std::string& text, const std::string& what)
+{
+    std::size_t n = 0;
+    for (auto pos = text.find(what); pos != std::string::npos; pos = text.find(what, pos + 1))
+        n++;
+    return n;
+}
+
+TEST_F(TestTrace, chrome_json)
+{
+    os::thread_synchronizer sync("test.trace \"quoted\"");
+    std::thread other([&sync]() {
+        os::trace::span s("other", "test");
+        if (auto lock = sync.lock())
+            os::sleep_for_ns(20000000);
+    });
+    os::sleep_for_ns(5000000);
+    {
+        os::trace::span s("main", "test");
+        if (auto lock = sync.lock())
+        {
+        }
+        os::file::dump("trace.json", "x", 1);
+    }
+    other.join(); // the thread's spans must survive its exit
+
+    auto json = os::trace::chrome_json();
+    EXPECT_EQ(json.find("{\"displayTimeUnit\":\"ns\",\"traceEvents\":["), 0u);
+    if (!os::trace::enabled())
+    {
+        EXPECT_EQ(occurrences(json, "\"ph\":\"X\""), 0u);
+        return;
+    }
+
+    EXPECT_EQ(occurrences(json, "\"name\":\"main\",\"cat\":\"test\""), 1u);
+    EXPECT_EQ(occurrences(json, "\"name\":\"other\",\"cat\":\"test\""), 1u);
+    EXPECT_EQ(occurrences(json, "\"name\":\"dump\",\"cat\":\"file\""), 1u);
+    EXPECT_EQ(occurrences(json, "\"name\":\"test.trace \\\"quoted\\\"\",\"cat\":\"lock\""), 1u);
+
+    ASSERT_TRUE(os::trace::dump("trace.json"));
+    EXPECT_GT(os::file::size("trace.json"), json.size() / 2);
+
+    os::trace::reset();
+    EXPECT_EQ(occurrences(os::trace::chrome_json(), "\"ph\":\"X\""), 0u);
+}
+
+TEST_F(TestTrace, ring_overwrites_oldest)
+{
+    if (!os::trace::enabled())
+        return;
+    for (int i = 0; i < 100000; i++)
+        os::trace::span s("spin", "test");
+    auto n = occurrences(os::trace::chrome_json(), "\"name\":\"spin\"");
+    EXPECT_GT(n, 0u);
+    EXPECT_LT(n, 100000u);
+}
@@ -0,0 +1,116 @@
+#include "osal/os.h"
+#include "osal/watcher.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <string>
+
+class TestWatcher : public ::testing::Test {
+public:
+    TestWatcher() {}
+
+    ~TestWatcher() override {}
+
+    void SetUp() override
+    {
+        os::file::delete_dir(m_dir);
+        os::file::create_dir(m_dir);
+    }
+    void TearDown() override { os::file::delete_dir(m_dir); }
+
+    /// Polls until an event for @p path arrives, merging whatever else comes first
+    static unsigned wait_for(os::file::watcher& w, const std::string& path)
+    {
+        os::file::watch_event e;
+        auto deadline = os::clock::monotonic_ns() + os::clock::s_to_ns(5);
+        while (os::clock::monotonic_ns() < deadline)
+        {
+            if (w.poll(e, os::clock::ms_to_ns(100)) && e.path == path)
+                return e.changes;
+        }
+        return 0;
+    }
+
+protected:
+    const std::string m_dir{"./test_watcher"};
+};
+
+#ifdef __linux__
+
+TEST_F(TestWatcher, created_and_closed)
+{
+    os::file::watcher w;
+    ASSERT_TRUE(w.add(m_dir));
+    EXPECT_EQ(w.watch_count(), 1u);
+
+    auto file = m_dir + "/drop.txt";
+    EXPECT_EQ(os::file::dump(file, std::string("payload")), 7u);
+    auto changes = wait_for(w, file);
+    EXPECT_TRUE(changes & os::file::created);
+    EXPECT_TRUE(changes & os::file::closed);
+
+    EXPECT_TRUE(os::file::delete_file(file));
+    EXPECT_TRUE(wait_for(w, file) & os::file::deleted);
+}
+
+TEST_F(TestWatcher, coalesce)
+{
+    std::mutex mtx;
+    std::map<std::string, int> seen;
+    os::file::watcher w(
+        [&](const os::file::watch_event& e) {
+            std::lock_guard<std::mutex> lock(mtx);
+            seen[e.path]++;
+        },
+        os::clock::ms_to_ns(200));
+    ASSERT_TRUE(w.add(m_dir));
+
+    auto file = m_dir + "/chunks.txt";
+    for (int i = 0; i < 50; i++)
+        os::file::dump(file, std::string("chunk"), "ab");
+    os::sleep(600);
+
+    std::lock_guard<std::mutex> lock(mtx);
+    EXPECT_EQ(seen[file], 1);
+}
+
+TEST_F(TestWatcher, recursive)
+{
+    os::file::watcher w;
+    ASSERT_TRUE(w.add(m_dir));
+
+    auto sub = m_dir + "/sub";
+    EXPECT_TRUE(os::file::create_dir(sub));
+    EXPECT_TRUE(wait_for(w, sub) & os::file::created);
+    EXPECT_EQ(w.watch_count(), 2u);
+
+    auto file = sub + "/nested.txt";
+    EXPECT_TRUE(os::file::touch(file.c_str()));
+    EXPECT_TRUE(wait_for(w, file) & os::file::created);
+
+    EXPECT_TRUE(w.remove(m_dir));
+    EXPECT_FALSE(w.remove(m_dir));
+    EXPECT_EQ(w.watch_count(), 0u);
+}
+
+TEST_F(TestWatcher, queue_overflow_rescan)
+{
+    os::file::watcher w(0, 2);
+    ASSERT_TRUE(w.add(m_dir));
+    for (int i = 0; i < 20; i++)
+        os::file::touch((m_dir + "/f" + std::to_string(i)).c_str());
+    os::sleep(200);
+
+    EXPECT_TRUE(wait_for(w, m_dir) & os::file::rescan);
+}
+
+#endif
+
+TEST_F(TestWatcher, add_invalid)
+{
+    os::file::watcher w;
+    EXPECT_FALSE(w.add(m_dir + "/missing"));
+    EXPECT_FALSE(w.remove(m_dir));
+    EXPECT_EQ(w.watch_count(), 0u);
+}